@@ -0,0 +1,89 @@
+/**
+ *  NodeJs-Unreal v2.0.0 - childAgent.js
+ *
+ *  Preloaded (--require) into every subprocess script by process.js. Answers
+ *  the bridge's 'nue-agent' IPC commands (profiling, heap snapshots, stats)
+ *  from inside the child without the script's involvement.
+ *
+ *  Messages in : { type: 'nue-agent', cmd: 'profileStart'|'profileStop'|'heapsnapshot', file? }
+ *                { type: 'nue-agent', cmd: 'stats', intervalMs }   (0 stops sampling)
+ *                { type: 'ipc-event-emitter', ..., nueTrace: id }   (traced event for the script)
+ *  Messages out: { type: 'nue-agent', kind: 'cpuprofile'|'heapsnapshot', path, error }
+ *                { type: 'nue-agent', kind: 'stats', stats }
+ *                { type: 'nue-agent', kind: 'trace', id, hops }
+ */
+
+const profiler = require('./profiler');
+
+let stopSampler = null;
+
+function reply(msg) {
+	if (process.connected) process.send(Object.assign({ type: 'nue-agent' }, msg));
+}
+
+// Wall-clock microseconds since the epoch, same basis as process.js.
+function nowMicros() {
+	return Math.round((performance.timeOrigin + performance.now()) * 1000);
+}
+
+// This listener runs before the script's own (it's registered first), so the
+// script's handlers for the event have all returned by the next tick.
+function traceEvent(id) {
+	const received = nowMicros();
+	process.nextTick(() => reply({ kind: 'trace', id, hops: [['receive', received], ['handled', nowMicros()]] }));
+}
+
+function onAgentMessage(msg) {
+	if (msg && msg.type === 'ipc-event-emitter' && msg.nueTrace) {
+		traceEvent(msg.nueTrace);
+		return;
+	}
+	if (!msg || msg.type !== 'nue-agent') return;
+	switch (msg.cmd) {
+		case 'profileStart':
+			profiler.startCpuProfile().catch(e => reply({ kind: 'cpuprofile', path: '', error: e.message }));
+			break;
+		case 'profileStop':
+			profiler.stopCpuProfile(msg.file)
+				.then(p => reply({ kind: 'cpuprofile', path: p, error: '' }))
+				.catch(e => reply({ kind: 'cpuprofile', path: '', error: e.message }));
+			break;
+		case 'heapsnapshot':
+			profiler.writeHeapSnapshot(msg.file)
+				.then(p => reply({ kind: 'heapsnapshot', path: p, error: '' }))
+				.catch(e => reply({ kind: 'heapsnapshot', path: '', error: e.message }));
+			break;
+		case 'stats':
+			if (stopSampler) { stopSampler(); stopSampler = null; }
+			if (msg.intervalMs > 0) stopSampler = profiler.startStatsSampler(msg.intervalMs, stats => reply({ kind: 'stats', stats }));
+			break;
+		default:
+			break;
+	}
+}
+
+// Our 'message' listener must not keep a finished script alive. An explicit
+// channel.unref() does that, but it also turns off node's automatic ref counting
+// of 'message'/'disconnect' listeners, so take that over: the channel is ref'd
+// exactly while the script (or the pool loader) listens on it.
+function isChannelEvent(name) {
+	return name === 'message' || name === 'disconnect';
+}
+
+function onNewListener(name) {
+	if (isChannelEvent(name) && process.channel) process.channel.ref();
+}
+
+function onRemoveListener(name) {
+	if (!isChannelEvent(name) || !process.channel) return;
+	const others = process.listenerCount('message') + process.listenerCount('disconnect') - 1;
+	if (others > 0) process.channel.ref();
+	else process.channel.unref();
+}
+
+if (process.send) {
+	process.on('message', onAgentMessage);
+	process.channel.unref();
+	process.on('newListener', onNewListener);
+	process.on('removeListener', onRemoveListener);
+}
@@ -0,0 +1,51 @@
+/**
+ *  NodeJs-Unreal v2.0.0 - childLoader.js
+ *
+ *  Loader stub for process.js's warm child pool. The bridge forks this ahead
+ *  of time (with childAgent.js preloaded, like any subprocess script) and it
+ *  idles until asked to load a script, so launchSubprocess skips node startup.
+ *
+ *  Messages in : { type: 'nue-loader', cmd: 'load', path }
+ *  Messages out: { type: 'nue-loader', kind: 'ready' }
+ *                { type: 'nue-loader', kind: 'loadFailed', error }
+ *
+ *  A script that can't be resolved is reported without running anything, so
+ *  the child stays clean and goes back to the pool. Once a script has run the
+ *  child belongs to it and exits with it, exactly like a freshly forked one.
+ */
+
+const Module = require('module');
+
+function reply(msg) {
+	if (process.connected) process.send(Object.assign({ type: 'nue-loader' }, msg));
+}
+
+function onIdleDisconnect() {
+	// Bridge went away while we were idle.
+	process.exit(0);
+}
+
+function onLoaderMessage(msg) {
+	if (!msg || msg.type !== 'nue-loader' || msg.cmd !== 'load') return;
+
+	let resolved;
+	try {
+		resolved = require.resolve(msg.path);
+	} catch (e) {
+		reply({ kind: 'loadFailed', error: e.message });
+		return;
+	}
+
+	// Drop our refs on the IPC channel: from here on the script's own listeners
+	// decide how long this process lives.
+	process.removeListener('message', onLoaderMessage);
+	process.removeListener('disconnect', onIdleDisconnect);
+
+	// Become the script: argv and require.main look as if it had been forked directly.
+	process.argv[1] = resolved;
+	Module.runMain(resolved);
+}
+
+process.on('message', onLoaderMessage);
+process.on('disconnect', onIdleDisconnect);
+reply({ kind: 'ready' });
@@ -0,0 +1,34 @@
+// Stream example: unbounded binary transfers in both directions.
+//
+// Unreal -> script: OpenStream("upload"), WriteStream(...) chunks, EndStream(). The
+// script gets a node Readable and reports the byte count back as an 'uploaded' event.
+// Script -> Unreal: EmitEvent("download", "{\"size\":262144,\"count\":32}"). The
+// script writes count chunks to ipc.createStream('download'); bind OnStreamChunkNative.
+
+const ipc = require('ipc-event-emitter').default(process);
+
+ipc.on('upload', (readable, info) => {
+	let total = 0;
+	readable.on('data', (chunk) => { total += chunk.length; });
+	readable.on('end', () => ipc.emit('uploaded', { total, expected: info.size }));
+});
+
+ipc.on('download', (opts) => {
+	const size = (opts && opts.size) || 256 * 1024;
+	const count = (opts && opts.count) || 32;
+	const chunk = Buffer.alloc(size, 0xCD);
+	const out = ipc.createStream('download', { size: size * count });
+
+	let written = 0;
+	const pump = () => {
+		while (written < count) {
+			written++;
+			// Respect backpressure: Unreal acks chunks as it consumes them.
+			if (!out.write(chunk)) { out.once('drain', pump); return; }
+		}
+		out.end();
+	};
+	pump();
+});
+
+console.log('streamEcho ready');
@@ -7,18 +7,31 @@
  *
  *  Frame: [4]MAGIC 'NUE\x01' [1]TYPE [4]headerLen [header utf8] [4]binLen [binary]
  *
+ *  Frames larger than the bulk threshold are cut into FRAGMENT frames
+ *  ([4]id [1]flags + slice of the encoded frame) and written from a low priority
+ *  lane, so control, log and small event frames interleave with bulk transfers.
+ *
  *  It can run user scripts two ways:
  *    - inline      : require()'d into this process (default, lowest latency)
- *    - subprocess  : fork()'d as a child (isolated, real IPC channel)
+ *    - subprocess  : fork()'d as a child (isolated, real IPC channel), optionally
+ *                    loaded into a pre-forked warm child (childPool control)
  *  Both expose the same `require('ipc-event-emitter').default(process)` API,
  *  bridged here to the Unreal side.
  */
 
 const { fork } = require('child_process');
+const { Readable, Writable } = require('stream');
+const { performance } = require('perf_hooks');
 const path = require('path');
 const fs = require('fs');
 const util = require('util');
 const childProcess = require('child_process');
+const profiler = require('./profiler');
+
+// Preloaded into every subprocess script to answer profiling/stats requests.
+const CHILD_AGENT = path.join(__dirname, 'childAgent.js');
+// Forked ahead of time by the warm child pool; loads the script on request.
+const CHILD_LOADER = path.join(__dirname, 'childLoader.js');
 
 const activeChildren = {};   // scriptName -> { child }
 const watchedScripts = {};   // fullPath   -> fs watcher
@@ -28,6 +41,10 @@ const npmAttempted = new Set();   // scriptName guard against install loops
 
 let scriptRoot = '../../../../../';
 let autoResolveNpm = true;        // toggled from Unreal via the npmAutoResolve control
+let statsIntervalMs = 0;          // runtime stats sampling period, 0 = off (stats control)
+let stopBridgeSampler = null;
+let childPoolSize = 0;            // warm idle children kept ready (childPool control)
+const childPool = [];             // idle pre-forked children, oldest first
 
 // Resolve a script to a full path, preferring <projectRoot>/<scriptPath> and
 // falling back to the plugin's own Content/Scripts (where process.js lives), so
@@ -61,7 +78,8 @@ function findPackageDir(startDir) {
 
 const MAGIC = Buffer.from([0x4E, 0x55, 0x45, 0x01]);
 const T_LOG = 0x01, T_ACTION = 0x02, T_EVENT = 0x03, T_ERROR = 0x04,
-	T_CONTROL = 0x05, T_PLOG = 0x06, T_NPM = 0x07;
+	T_CONTROL = 0x05, T_PLOG = 0x06, T_NPM = 0x07, T_FRAGMENT = 0x08, T_STREAM = 0x09,
+	T_TRACE = 0x0A, T_PROFILE = 0x0B, T_STATS = 0x0C, T_TICK = 0x0D, T_TICK_RESULT = 0x0E;
 
 // Capture the real stdout write before console is overridden.
 const rawStdoutWrite = process.stdout.write.bind(process.stdout);
@@ -72,16 +90,129 @@ function u32le(n) {
 	return b;
 }
 
-function writeFrame(type, headerStr, binaryBuf) {
+function encodeFrame(type, headerStr, binaryBuf) {
 	const header = Buffer.from(headerStr != null ? String(headerStr) : '', 'utf8');
 	const binary = binaryBuf || Buffer.alloc(0);
-	const frame = Buffer.concat([
+	return Buffer.concat([
 		MAGIC,
 		Buffer.from([type]),
 		u32le(header.length), header,
 		u32le(binary.length), binary,
 	]);
-	rawStdoutWrite(frame);
+}
+
+// ---------------------------------------------------------------------------
+// Outbound priority lanes (control > small events > bulk)
+// ---------------------------------------------------------------------------
+
+const LANE_CONTROL = 0, LANE_EVENT = 1, LANE_BULK = 2;
+const lanes = [[], [], []];  // bulk entries are { frame, offset, id }
+let bulkThreshold = 256 * 1024;  // synced from Unreal via the frameLanes control
+let fragmentSize = 64 * 1024;
+let nextFragmentId = 1;
+let pumpScheduled = false;
+let stdoutBlocked = false;
+const tracedFrames = new WeakMap(); // encoded frame (or last fragment) -> trace id, stamped when written
+
+function laneForType(type) {
+	return (type === T_LOG || type === T_EVENT || type === T_TRACE || type === T_STATS) ? LANE_EVENT : LANE_CONTROL;
+}
+
+function writeOut(buf) {
+	if (!rawStdoutWrite(buf)) {
+		stdoutBlocked = true;
+		process.stdout.once('drain', () => {
+			stdoutBlocked = false;
+			pumpLanes();
+		});
+	}
+	const traceId = tracedFrames.get(buf);
+	if (traceId) writeFrame(T_TRACE, JSON.stringify({ id: traceId, hops: [['write', nowMicros()]] }));
+}
+
+function nextBulkFragment() {
+	const entry = lanes[LANE_BULK][0];
+	if (entry.offset === 0 && entry.frame.length <= fragmentSize) {
+		lanes[LANE_BULK].shift();
+		entry.sent = true;
+		return entry.frame;
+	}
+	const end = Math.min(entry.offset + fragmentSize, entry.frame.length);
+	const last = end >= entry.frame.length;
+	const fragHeader = Buffer.alloc(5);
+	fragHeader.writeUInt32LE(entry.id, 0);
+	fragHeader[4] = last ? 0x01 : 0x00;
+	const fragment = encodeFrame(T_FRAGMENT, '', Buffer.concat([fragHeader, entry.frame.subarray(entry.offset, end)]));
+	entry.offset = end;
+	if (last) {
+		lanes[LANE_BULK].shift();
+		entry.sent = true;
+		const traceId = tracedFrames.get(entry.frame);
+		if (traceId) tracedFrames.set(fragment, traceId);
+	}
+	return fragment;
+}
+
+function schedulePump() {
+	if (pumpScheduled || stdoutBlocked) return;
+	pumpScheduled = true;
+	setImmediate(pumpLanes);
+}
+
+function pumpLanes() {
+	pumpScheduled = false;
+	while (!stdoutBlocked) {
+		if (lanes[LANE_CONTROL].length) { writeOut(lanes[LANE_CONTROL].shift()); continue; }
+		if (lanes[LANE_EVENT].length) { writeOut(lanes[LANE_EVENT].shift()); continue; }
+		if (lanes[LANE_BULK].length) {
+			writeOut(nextBulkFragment());
+			// Yield after every fragment so frames produced meanwhile go out first.
+			if (lanes[LANE_BULK].length) schedulePump();
+		}
+		return;
+	}
+}
+
+// Write out everything still queued, ignoring backpressure (the stream buffers
+// it), then exit once the last write has been handed to the OS. Used on shutdown
+// so queued events and bulk transfers aren't dropped by process.exit.
+function flushLanesAndExit(code) {
+	while (lanes[LANE_CONTROL].length || lanes[LANE_EVENT].length || lanes[LANE_BULK].length) {
+		if (lanes[LANE_CONTROL].length) rawStdoutWrite(lanes[LANE_CONTROL].shift());
+		else if (lanes[LANE_EVENT].length) rawStdoutWrite(lanes[LANE_EVENT].shift());
+		else rawStdoutWrite(nextBulkFragment());
+	}
+	// Don't hang if the reader has stopped reading.
+	setTimeout(() => process.exit(code), 2000).unref();
+	rawStdoutWrite('', () => process.exit(code));
+}
+
+// `lane` is optional; by default it's picked from the frame type and size.
+// With a `traceId`, a 'write' hop is reported once the frame's last byte is written.
+// Returns the bulk lane entry if the frame was queued there (its `sent` flag is
+// set once the last byte is written), null otherwise.
+function writeFrame(type, headerStr, binaryBuf, lane, traceId) {
+	const frame = encodeFrame(type, headerStr, binaryBuf);
+	if (lane === undefined) lane = laneForType(type);
+	if (traceId) tracedFrames.set(frame, traceId);
+
+	if (lane === LANE_BULK || frame.length > bulkThreshold) {
+		const entry = { frame, offset: 0, id: nextFragmentId++ };
+		lanes[LANE_BULK].push(entry);
+		schedulePump();
+		return entry;
+	}
+
+	// Fast path: nothing of equal or higher priority is waiting, write straight through.
+	let ahead = stdoutBlocked;
+	for (let i = 0; i <= lane && !ahead; i++) ahead = lanes[i].length > 0;
+	if (!ahead) {
+		writeOut(frame);
+		return null;
+	}
+	lanes[lane].push(frame);
+	schedulePump();
+	return null;
 }
 
 function fmt(args) {
@@ -97,6 +228,12 @@ function sendError(scriptName, message, stack) {
 function sendNpmResult(installed, error) {
 	writeFrame(T_NPM, JSON.stringify({ installed: !!installed, error: error || '' }));
 }
+function sendProfileResult(scriptName, kind, filePath, error) {
+	writeFrame(T_PROFILE, JSON.stringify({ script: scriptName || '', kind, path: filePath || '', error: error || '' }));
+}
+function sendStats(scriptName, stats) {
+	writeFrame(T_STATS, JSON.stringify(Object.assign({ script: scriptName || '' }, stats)));
+}
 
 // Route all script/console output through framed LOG messages.
 console.log = (...a) => sendLog(fmt(a));
@@ -163,34 +300,464 @@ function injectBinaries(value, buffers) {
 	return value;
 }
 
+// ---------------------------------------------------------------------------
+// Event tracing (toggled from Unreal via the trace control)
+// ---------------------------------------------------------------------------
+//
+// Traced events carry {id, parent?, hops:[[stage, micros], ...]} in their header.
+// Hops of events received from Unreal go back in a TRACE frame once delivered;
+// a multicast reports 'handleFrame'/'fanout' under its own id and each target's
+// hops under a new id with the multicast as parent (plus name and script);
+// subprocess children report their own 'receive'/'handled' hops the same way
+// (see childAgent.js). Events emitted here get their own id (node id space
+// starts at 2^40), name the event being handled at the time, if any, as parent,
+// and get a 'write' hop in a TRACE frame once their last byte hits the pipe.
+
+let traceEnabled = false;
+let nextTraceId = 2 ** 40;
+let currentTraceId = 0;
+
+// Wall-clock microseconds since the epoch, same basis as FNodeEventTracer::NowMicros.
+function nowMicros() {
+	return Math.round((performance.timeOrigin + performance.now()) * 1000);
+}
+
+// ---------------------------------------------------------------------------
+// Delta-encoded state events (opted in per event name via the delta control)
+// ---------------------------------------------------------------------------
+//
+// For a delta event the bridge remembers the last args (placeholder tree) and
+// buffers it sent per script+name, and sends only what changed:
+//   keyframe : {..., args, delta:{seq, key:1}}              full value, as usual
+//   delta    : {..., delta:{seq, base, ops, bufs, bins}}    no args
+//     ops  : ['s', path, value] set, ['d', path] delete; path = [key|index, ...]
+//     bufs : buffer count after the update
+//     bins : [i, offset, t] write table buffer t into buffer i at offset, or
+//            replace buffer i with it when offset is -1
+// A keyframe goes out every `interval` updates, and on the next update after
+// the receiver asks for one (keyframe control, e.g. when `base` doesn't match
+// what it holds). Frames pick their lane by size like any event, except while
+// the previous frame of the same stream is still queued on the bulk lane: then
+// they follow it there, so a small delta never overtakes the frame it builds on.
+
+const deltaIntervals = new Map(); // eventName -> keyframe interval
+const deltaStates = new Map();    // script + '\n' + eventName -> { seq, sinceKey, args, buffers, forceKey, bulk }
+const DELTA_BLOCK = 256;          // buffer diff granularity (bytes)
+
+function isPlainObject(v) {
+	return v !== null && typeof v === 'object' && !Array.isArray(v);
+}
+
+function diffValue(prev, next, path, ops) {
+	if (prev === next) return;
+	if (isPlainObject(prev) && isPlainObject(next)) {
+		for (const k of Object.keys(next)) {
+			path.push(k);
+			if (Object.prototype.hasOwnProperty.call(prev, k)) diffValue(prev[k], next[k], path, ops);
+			else ops.push(['s', path.slice(), next[k]]);
+			path.pop();
+		}
+		for (const k of Object.keys(prev)) {
+			if (!Object.prototype.hasOwnProperty.call(next, k)) ops.push(['d', path.concat(k)]);
+		}
+		return;
+	}
+	if (Array.isArray(prev) && Array.isArray(next) && prev.length === next.length) {
+		for (let i = 0; i < next.length; i++) {
+			path.push(i);
+			diffValue(prev[i], next[i], path, ops);
+			path.pop();
+		}
+		return;
+	}
+	ops.push(['s', path.slice(), next]);
+}
+
+// Dirty DELTA_BLOCK runs of `next` against `prev` (same length), merged; null if most of it changed.
+function diffBuffer(prev, next) {
+	const ranges = [];
+	let dirty = 0;
+	for (let off = 0; off < next.length; off += DELTA_BLOCK) {
+		const end = Math.min(off + DELTA_BLOCK, next.length);
+		if (next.compare(prev, off, end, off, end) === 0) continue;
+		const last = ranges[ranges.length - 1];
+		if (last && last[1] === off) last[1] = end;
+		else ranges.push([off, end]);
+		dirty += end - off;
+	}
+	return dirty * 2 > next.length ? null : ranges;
+}
+
+function setDeltaInterval(name, interval) {
+	if (interval > 0) {
+		deltaIntervals.set(name, interval);
+		return;
+	}
+	deltaIntervals.delete(name);
+	for (const key of deltaStates.keys()) {
+		if (key.endsWith('\n' + name)) deltaStates.delete(key);
+	}
+}
+
+function requestKeyframe(scriptName, name) {
+	const state = deltaStates.get(scriptName + '\n' + name);
+	if (state) state.forceKey = true;
+}
+
+// Fills `event` (args or delta) and returns the binary table for it.
+function encodeDeltaEvent(event, replaced, buffers, interval) {
+	const key = event.script + '\n' + event.name;
+	let state = deltaStates.get(key);
+	if (!state) {
+		state = { seq: 0, sinceKey: 0, args: null, buffers: [], forceKey: true };
+		deltaStates.set(key, state);
+	}
+	const base = state.seq;
+	state.seq++;
+	// Scripts often mutate the same Buffer in place; keep our own copy to diff against.
+	const kept = buffers.map(b => Buffer.from(b));
+
+	if (state.forceKey || state.sinceKey + 1 >= interval) {
+		state.forceKey = false;
+		state.sinceKey = 0;
+		state.args = replaced;
+		state.buffers = kept;
+		event.args = replaced;
+		event.delta = { seq: state.seq, key: 1 };
+		return buildBinaryTable(buffers);
+	}
+
+	const ops = [];
+	diffValue(state.args, replaced, [], ops);
+	const table = [];
+	const bins = [];
+	for (let i = 0; i < buffers.length; i++) {
+		const prev = state.buffers[i];
+		const next = buffers[i];
+		const ranges = prev && prev.length === next.length ? diffBuffer(prev, next) : null;
+		if (!ranges) {
+			bins.push([i, -1, table.length]);
+			table.push(next);
+			continue;
+		}
+		for (const [start, end] of ranges) {
+			bins.push([i, start, table.length]);
+			table.push(next.subarray(start, end));
+		}
+	}
+
+	state.sinceKey++;
+	state.args = replaced;
+	state.buffers = kept;
+	event.delta = { seq: state.seq, base, ops, bufs: buffers.length, bins };
+	return buildBinaryTable(table);
+}
+
+// ---------------------------------------------------------------------------
+// Lockstep ticks
+// ---------------------------------------------------------------------------
+//
+// In lockstep mode Unreal sends one TICK frame per engine tick and blocks (up
+// to its budget) for the answer:
+//   TICK        {script, frame, dt, name, reply, inputs}  + binary table
+//   TICK_RESULT {script, frame, args}                     + binary table
+// The tick is delivered to the script as ipc.on(name, (dt, inputs, frame) => ...)
+// and answered by ipc.emit(reply, result), which goes back as the TICK_RESULT on
+// the control lane so nothing queued can delay it.
+//
+// An answer emitted while the tick handler runs belongs to that tick. Anything
+// later (async answers, subprocess scripts) must echo the frame as result.frame.
+// Only an answer to the latest tick is sent; answers to superseded frames, repeat
+// answers and answers that can't be attributed are dropped, never relabelled.
+
+const lockstepScripts = new Map(); // scriptName -> { reply, latest, answered, warned }
+let deliveringTick = null;         // { script, frame } while a tick handler runs inline
+
+function handleTickFrame(header, binary) {
+	const tick = JSON.parse(header);
+	const scriptName = tick.script || '';
+	const buffers = parseBinaryTable(binary);
+	const inputs = (tick.inputs || []).map(a => injectBinaries(a, buffers));
+
+	const state = lockstepScripts.get(scriptName) || { warned: false };
+	state.reply = tick.reply || 'tickResult';
+	state.latest = tick.frame;
+	state.answered = false;
+	lockstepScripts.set(scriptName, state);
+
+	deliveringTick = { script: scriptName, frame: tick.frame };
+	try {
+		deliverEventToScript(scriptName, tick.name || 'tick', [tick.dt, inputs, tick.frame]);
+	} finally {
+		deliveringTick = null;
+	}
+}
+
+// Returns true if this emit is a tick answer (sent or dropped), false for ordinary events.
+function answerTick(scriptName, name, args) {
+	const state = lockstepScripts.get(scriptName);
+	if (!state || state.reply !== name) return false;
+
+	let frame;
+	if (deliveringTick && deliveringTick.script === scriptName) frame = deliveringTick.frame;
+	else if (args && args[0] && typeof args[0].frame === 'number') frame = args[0].frame;
+
+	if (frame === undefined) {
+		if (!state.warned) {
+			state.warned = true;
+			plog(`"${scriptName}" answered a tick outside its handler without result.frame; dropped.`);
+		}
+		return true;
+	}
+	if (frame !== state.latest || state.answered) return true;
+	state.answered = true;
+
+	const buffers = [];
+	const replaced = (args || []).map(a => extractBinaries(a, buffers));
+	const result = { script: scriptName, frame, args: replaced };
+	writeFrame(T_TICK_RESULT, JSON.stringify(result), buildBinaryTable(buffers), LANE_CONTROL);
+	return true;
+}
+
 // ---------------------------------------------------------------------------
 // Unreal <-> script event bridge
 // ---------------------------------------------------------------------------
 
 function sendEventToUnreal(scriptName, name, args) {
+	if (lockstepScripts.size && answerTick(scriptName || '', name, args)) return;
+
+	let trace = null;
+	if (traceEnabled) {
+		trace = { id: nextTraceId++, hops: [['emit', nowMicros()]] };
+		if (currentTraceId) trace.parent = currentTraceId;
+	}
 	const buffers = [];
 	const replaced = (args || []).map(a => extractBinaries(a, buffers));
-	const header = JSON.stringify({ script: scriptName || '', name: name, args: replaced });
-	writeFrame(T_EVENT, header, buildBinaryTable(buffers));
+	const event = { script: scriptName || '', name: name };
+
+	const interval = deltaIntervals.get(name);
+	let binary;
+	if (interval) {
+		binary = encodeDeltaEvent(event, replaced, buffers, interval);
+	} else {
+		event.args = replaced;
+		binary = buildBinaryTable(buffers);
+	}
+
+	if (trace) event.trace = trace;
+	const traceId = trace ? trace.id : 0;
+	if (!interval) {
+		writeFrame(T_EVENT, JSON.stringify(event), binary, undefined, traceId);
+		return;
+	}
+	const state = deltaStates.get(event.script + '\n' + event.name);
+	const lane = state.bulk && !state.bulk.sent ? LANE_BULK : undefined;
+	state.bulk = writeFrame(T_EVENT, JSON.stringify(event), binary, lane, traceId);
 }
 
-function deliverEventToScript(scriptName, name, args) {
+// `trace` is the incoming event's trace object (or undefined); hops are appended to it.
+function deliverEventToScript(scriptName, name, args, trace) {
 	const set = inlineEmitters.get(scriptName);
 	if (set && set.size) {
+		if (trace) {
+			trace.hops.push(['deliver', nowMicros()]);
+			currentTraceId = trace.id;
+		}
 		for (const em of set) {
 			try { em._deliver(name, args); }
 			catch (e) { sendError(scriptName, e.message, e.stack); }
 		}
+		if (trace) {
+			currentTraceId = 0;
+			trace.hops.push(['handled', nowMicros()]);
+		}
 		return;
 	}
 	const info = activeChildren[scriptName];
 	if (info && info.child && info.child.connected) {
-		info.child.send({ type: 'ipc-event-emitter', emit: [name, ...args] });
+		if (!trace) {
+			info.child.send({ type: 'ipc-event-emitter', emit: [name, ...args] });
+			return;
+		}
+		trace.hops.push(['deliver', nowMicros()]);
+		// The child's agent stamps receive/handled and reports them back under this id.
+		info.child.send({ type: 'ipc-event-emitter', emit: [name, ...args], nueTrace: trace.id });
 		return;
 	}
 	plog(`No live target for event '${name}' on script '${scriptName}'.`);
 }
 
+// Multicast: one EVENT frame with {scripts:[...]} instead of {script} reaches
+// every running script matching any entry (* and ? wildcards; empty = all).
+// Inline scripts all get the very same args, Buffers included, so the cost
+// doesn't grow with the number of in-process subscribers. That sharing is by
+// reference: a subscriber that mutates an arg or Buffer changes it for the
+// subscribers after it, so handlers should treat multicast args as read-only.
+
+function scriptPattern(pattern) {
+	const source = pattern.replace(/[.+^${}()|[\]\\]/g, '\\$&').replace(/\*/g, '.*').replace(/\?/g, '.');
+	return new RegExp('^' + source + '$');
+}
+
+function multicastTargets(patterns) {
+	const running = new Set([...inlineEmitters.keys(), ...Object.keys(activeChildren)]);
+	if (!patterns.length || patterns.includes('*')) return [...running];
+	// Compiled per frame, not cached: patterns come from callers and a cache keyed
+	// by them would grow without bound. A frame carries only a handful.
+	const matchers = patterns.map(scriptPattern);
+	return [...running].filter(name => matchers.some(re => re.test(name)));
+}
+
+function multicastEventToScripts(patterns, name, args, trace) {
+	const targets = multicastTargets(patterns);
+	if (!targets.length) {
+		plog(`No running script matches multicast '${name}' (${patterns.join(', ') || '*'}).`);
+		return;
+	}
+	if (!trace) {
+		for (const scriptName of targets) deliverEventToScript(scriptName, name, args);
+		return;
+	}
+	// Each target gets its own trace (node id, the multicast as parent) so the
+	// deliver/handled hops of different targets don't interleave on one track.
+	for (const scriptName of targets) {
+		const targetTrace = { id: nextTraceId++, parent: trace.id, name, script: scriptName, hops: [] };
+		deliverEventToScript(scriptName, name, args, targetTrace);
+		writeFrame(T_TRACE, JSON.stringify(targetTrace));
+	}
+	trace.hops.push(['fanout', nowMicros()]);
+}
+
+// ---------------------------------------------------------------------------
+// Streams: unbounded binary transfers delivered chunk by chunk
+// ---------------------------------------------------------------------------
+//
+// STREAM frames carry a JSON header {op, id, ...}; 'data' frames carry the chunk
+// as their binary. Opening side allocates the id (separate id space per
+// direction). The receiver acks consumed bytes and the sender keeps at most
+// `streamWindow` unacked bytes in flight, so buffering stays bounded on both
+// ends. Totals are plain Numbers (exact up to 2^53 bytes).
+//   open  {id, script, name, size}   size -1 = unknown
+//   data  {id}                       + chunk
+//   end   {id, total}
+//   abort {id, reason}
+//   ack    {id, bytes}               receiver -> sender
+//   reject {id, reason}              receiver -> sender, stream refused at open
+// Stream traffic rides the bulk lane so chunks stay in order whatever their size.
+
+let streamWindow = 4 * 1024 * 1024;  // synced from Unreal via the streamWindow control
+let nextStreamId = 1;
+const outboundStreams = new Map();  // id -> { inFlight, held }  (node -> Unreal)
+const inboundStreams = new Map();   // id -> { readable, unacked }  (Unreal -> node)
+
+function sendStreamFrame(header, chunk) {
+	const unordered = header.op === 'ack' || header.op === 'reject';
+	writeFrame(T_STREAM, JSON.stringify(header), chunk, unordered ? LANE_CONTROL : LANE_BULK);
+}
+
+// Writable that forwards to Unreal's stream delegates. Exposed as ipc.createStream(name, { size }).
+function createOutboundStream(scriptName, name, opts) {
+	const id = nextStreamId++;
+	const state = { inFlight: 0, held: null };
+	let total = 0;
+	outboundStreams.set(id, state);
+	sendStreamFrame({ op: 'open', id, script: scriptName || '', name, size: (opts && opts.size >= 0) ? opts.size : -1 });
+
+	return new Writable({
+		write(chunk, encoding, callback) {
+			const buf = Buffer.isBuffer(chunk) ? chunk : Buffer.from(chunk, encoding);
+			total += buf.length;
+			// Hold the chunk and its callback (Writable backpressure) until Unreal has acked
+			// enough for it to fit the window. A chunk larger than the window goes out alone.
+			state.held = { buf, callback };
+			sendHeldChunk(id, state);
+		},
+		final(callback) {
+			sendStreamFrame({ op: 'end', id, total });
+			outboundStreams.delete(id);
+			callback();
+		},
+		destroy(err, callback) {
+			state.held = null;
+			if (outboundStreams.delete(id)) {
+				sendStreamFrame({ op: 'abort', id, reason: err ? err.message : 'destroyed' });
+			}
+			callback(err);
+		},
+	});
+}
+
+function sendHeldChunk(id, state) {
+	const held = state.held;
+	if (!held || (state.inFlight > 0 && state.inFlight + held.buf.length > streamWindow)) return;
+	state.held = null;
+	state.inFlight += held.buf.length;
+	sendStreamFrame({ op: 'data', id }, held.buf);
+	held.callback();
+}
+
+function ackInbound(id, entry) {
+	if (entry.unacked > 0) {
+		sendStreamFrame({ op: 'ack', id, bytes: entry.unacked });
+		entry.unacked = 0;
+	}
+}
+
+function handleStreamFrame(header, binary) {
+	let msg;
+	try { msg = JSON.parse(header); }
+	catch (e) { sendError('', 'stream header parse error: ' + e.message, e.stack); return; }
+
+	switch (msg.op) {
+		case 'open': {
+			const set = inlineEmitters.get(msg.script);
+			if (!set || !set.size) {
+				sendStreamFrame({ op: 'reject', id: msg.id, reason: `no inline script '${msg.script}' to receive stream '${msg.name}'` });
+				return;
+			}
+			const entry = { readable: null, unacked: 0 };
+			entry.readable = new Readable({
+				highWaterMark: streamWindow,
+				// Consumer wants more: release the credit we held back.
+				read() { ackInbound(msg.id, entry); },
+			});
+			inboundStreams.set(msg.id, entry);
+			deliverEventToScript(msg.script, msg.name, [entry.readable, { size: msg.size }]);
+			break;
+		}
+		case 'data': {
+			const entry = inboundStreams.get(msg.id);
+			if (!entry) return;
+			entry.unacked += binary.length;
+			if (entry.readable.push(binary)) ackInbound(msg.id, entry);
+			break;
+		}
+		case 'end': {
+			const entry = inboundStreams.get(msg.id);
+			if (!entry) return;
+			inboundStreams.delete(msg.id);
+			entry.readable.push(null);
+			break;
+		}
+		case 'abort': {
+			const entry = inboundStreams.get(msg.id);
+			if (!entry) return;
+			inboundStreams.delete(msg.id);
+			entry.readable.destroy(new Error(msg.reason || 'stream aborted'));
+			break;
+		}
+		case 'ack': {
+			const state = outboundStreams.get(msg.id);
+			if (!state) return;
+			state.inFlight = Math.max(0, state.inFlight - (msg.bytes || 0));
+			sendHeldChunk(msg.id, state);
+			break;
+		}
+		default:
+			plog(`Unknown stream op: ${msg.op}`);
+	}
+}
+
 // Installed for inline scripts: require('ipc-event-emitter').default(process)
 // finds this and binds to the currently-loading script.
 globalThis.__unrealBridge = {
@@ -199,6 +766,9 @@ globalThis.__unrealBridge = {
 		let set = inlineEmitters.get(scriptName);
 		if (!set) { set = new Set(); inlineEmitters.set(scriptName, set); }
 		set.add(emitter);
+		if (!emitter.createStream) {
+			emitter.createStream = (name, opts) => createOutboundStream(scriptName, name, opts);
+		}
 	},
 };
 
@@ -278,6 +848,106 @@ function resolveNpmAndRelaunch(scriptName, scriptPath, method, errMessage) {
 // Script launching
 // ---------------------------------------------------------------------------
 
+// silent: pipe stdout/stderr so we can re-frame them.
+// advanced serialization: preserve Buffers across the IPC channel.
+function forkChild(modulePath) {
+	return fork(modulePath, [], {
+		silent: true,
+		serialization: 'advanced',
+		execArgv: process.execArgv.concat(['--require', CHILD_AGENT]),
+	});
+}
+
+// ---------------------------------------------------------------------------
+// Warm child pool
+// ---------------------------------------------------------------------------
+//
+// Idle children running childLoader.js, already past node startup. A launch
+// takes one and tells it which script to load; the pool is topped up again in
+// the background. A child is only reused if its script never ran (it could
+// not be resolved) - once a script has executed, the child exits with it.
+//
+// A child counts as warm once the loader reports ready; until then launches
+// fork as usual. Children that die before that (e.g. an execArgv they can't
+// start with) are refilled with exponential backoff, and after a run of such
+// failures the pool stops refilling until childPool is set again.
+
+const CHILD_POOL_BACKOFF_MS = 100;
+const CHILD_POOL_BACKOFF_MAX_MS = 30000;
+const CHILD_POOL_MAX_EARLY_EXITS = 5;
+const readyPoolChildren = new WeakSet();
+let childPoolEarlyExits = 0;
+
+function onPooledChildMessage(msg) {
+	if (msg && msg.type === 'nue-loader' && msg.kind === 'ready') {
+		readyPoolChildren.add(this);
+		childPoolEarlyExits = 0;
+	}
+}
+
+function onPooledChildExit(code) {
+	const idx = childPool.indexOf(this);
+	if (idx >= 0) childPool.splice(idx, 1);
+	this.removeListener('message', onPooledChildMessage);
+	if (!readyPoolChildren.has(this)) {
+		childPoolEarlyExits++;
+		if (childPoolEarlyExits === CHILD_POOL_MAX_EARLY_EXITS) {
+			plog(`Warm child pool: ${childPoolEarlyExits} children exited during startup (last code ${code}), no longer refilling.`);
+		}
+	}
+	scheduleChildPoolRefill();
+}
+
+function poolChild(child) {
+	child.on('exit', onPooledChildExit);
+	child.on('message', onPooledChildMessage);
+	childPool.push(child);
+}
+
+function unpoolChild(child) {
+	child.removeListener('exit', onPooledChildExit);
+	child.removeListener('message', onPooledChildMessage);
+}
+
+let childPoolRefillPending = false;
+function scheduleChildPoolRefill() {
+	if (childPoolRefillPending) return;
+	if (childPoolEarlyExits >= CHILD_POOL_MAX_EARLY_EXITS && childPool.length <= childPoolSize) return;
+	childPoolRefillPending = true;
+	// Fork after the current launch has been handled so it doesn't compete with it,
+	// and back off while children keep dying before they're ready.
+	const delay = childPoolEarlyExits > 0
+		? Math.min(CHILD_POOL_BACKOFF_MS * 2 ** (childPoolEarlyExits - 1), CHILD_POOL_BACKOFF_MAX_MS)
+		: 0;
+	setTimeout(() => {
+		childPoolRefillPending = false;
+		while (childPool.length < childPoolSize && childPoolEarlyExits < CHILD_POOL_MAX_EARLY_EXITS) {
+			try { poolChild(forkChild(CHILD_LOADER)); }
+			catch (e) { plog('Warm child pool: ' + e.message); return; }
+		}
+		while (childPool.length > childPoolSize) {
+			const child = childPool.pop();
+			unpoolChild(child);
+			child.kill();
+		}
+	}, delay);
+}
+
+function takePooledChild() {
+	const idx = childPool.findIndex(c => readyPoolChildren.has(c) && c.connected && c.exitCode === null);
+	if (idx < 0) return null;
+	const [child] = childPool.splice(idx, 1);
+	unpoolChild(child);
+	scheduleChildPoolRefill();
+	return child;
+}
+
+function setChildPoolSize(size) {
+	childPoolSize = size > 0 ? size : 0;
+	childPoolEarlyExits = 0;
+	scheduleChildPoolRefill();
+}
+
 function launchSubprocess(scriptName, scriptPath) {
 	const fullPath = resolveScriptFullPath(scriptName, scriptPath);
 
@@ -289,44 +959,75 @@ function launchSubprocess(scriptName, scriptPath) {
 	try {
 		sendAction('begin ' + fullPath);
 
-		// silent: pipe stdout/stderr so we can re-frame them.
-		// advanced serialization: preserve Buffers across the IPC channel.
-		const child = fork(fullPath, [], { silent: true, serialization: 'advanced' });
+		const pooled = takePooledChild();
+		const child = pooled || forkChild(fullPath);
+		if (pooled) child.send({ type: 'nue-loader', cmd: 'load', path: fullPath });
+
+		let lastError = '';
+		const onStderr = (err) => { lastError += err; };
+		const onStdout = (msg) => {
+			const trimmed = msg.toString();
+			if (trimmed.length) sendLog(trimmed.replace(/\s+$/, ''));
+		};
+
+		const onExit = (code) => {
+			sendAction('end ' + fullPath);
+			delete activeChildren[scriptName];
+			if (code === 1 && lastError) {
+				sendError(scriptName, lastError.trim());
+				if (resolveNpmAndRelaunch(scriptName, scriptPath, 'child', lastError)) {
+					// relaunch scheduled
+				}
+			}
+		};
 
-		child.on('message', (data) => {
+		const onMessage = (data) => {
 			if (data && data.type === 'ipc-event-emitter' && Array.isArray(data.emit)) {
 				const [name, ...rest] = data.emit;
 				sendEventToUnreal(scriptName, name, rest);
+			} else if (data && data.type === 'nue-agent') {
+				if (data.kind === 'stats') sendStats(scriptName, data.stats);
+				else if (data.kind === 'trace') writeFrame(T_TRACE, JSON.stringify({ id: data.id, hops: data.hops }));
+				else sendProfileResult(scriptName, data.kind, data.path, data.error);
+			} else if (data && data.type === 'nue-loader' && data.kind === 'loadFailed') {
+				// Nothing ran in the child: report like a failed fork and hand it back to the pool.
+				child.removeListener('message', onMessage);
+				child.removeListener('exit', onExit);
+				if (child.stderr) child.stderr.removeListener('data', onStderr);
+				if (child.stdout) child.stdout.removeListener('data', onStdout);
+				if (activeChildren[scriptName] && activeChildren[scriptName].child === child) {
+					delete activeChildren[scriptName];
+				}
+				sendAction('end ' + fullPath);
+				sendError(scriptName, data.error);
+				if (childPool.length < childPoolSize) {
+					if (statsIntervalMs > 0) child.send({ type: 'nue-agent', cmd: 'stats', intervalMs: 0 });
+					poolChild(child);
+				} else {
+					child.kill();
+				}
 			}
-		});
+		};
+
+		child.on('message', onMessage);
+		if (statsIntervalMs > 0) {
+			child.send({ type: 'nue-agent', cmd: 'stats', intervalMs: statsIntervalMs });
+		}
 
-		let lastError = '';
 		if (child.stderr) {
 			child.stderr.setEncoding('utf8');
-			child.stderr.on('data', (err) => { lastError += err; });
+			child.stderr.on('data', onStderr);
 		}
 		if (child.stdout) {
 			child.stdout.setEncoding('utf8');
-			child.stdout.on('data', (msg) => {
-				const trimmed = msg.toString();
-				if (trimmed.length) sendLog(trimmed.replace(/\s+$/, ''));
-			});
+			child.stdout.on('data', onStdout);
 		}
 
-		child.on('exit', (code) => {
-			sendAction('end ' + fullPath);
-			delete activeChildren[scriptName];
-			if (code === 1 && lastError) {
-				sendError(scriptName, lastError.trim());
-				if (resolveNpmAndRelaunch(scriptName, scriptPath, 'child', lastError)) {
-					// relaunch scheduled
-				}
-			}
-		});
+		child.on('exit', onExit);
 
 		activeChildren[scriptName] = { child };
 		launchedScripts[fullPath] = { scriptName, method: 'child', scriptPath };
-		plog(`Launched child process for "${scriptName}".`);
+		plog(`Launched ${pooled ? 'warm ' : ''}child process for "${scriptName}".`);
 	} catch (error) {
 		sendError(scriptName, error.message, error.stack);
 	}
@@ -397,6 +1098,7 @@ function stopScript(scriptName) {
 		}
 		delete launchedScripts[fullPath];
 		npmAttempted.delete(scriptName);
+		lockstepScripts.delete(scriptName);
 	} catch (error) {
 		sendError(scriptName, error.message, error.stack);
 	}
@@ -454,6 +1156,58 @@ function watchScript(scriptName, scriptPath) {
 	}
 }
 
+// ---------------------------------------------------------------------------
+// Profiling & runtime stats
+// ---------------------------------------------------------------------------
+//
+// Targets are subprocess scripts by name; anything else (including inline
+// scripts, which share it) means the bridge process itself. Files land in
+// <project>/Saved/NodeJs/Profiles.
+
+function profileFilePath(label, ext) {
+	const stamp = new Date().toISOString().replace(/[:.]/g, '-');
+	const base = path.basename(label || 'process', '.js');
+	return path.resolve(scriptRoot, 'Saved', 'NodeJs', 'Profiles', `${base}-${stamp}.${ext}`);
+}
+
+function profileCommand(cmd, scriptName) {
+	const info = activeChildren[scriptName];
+	const kind = cmd === 'heapsnapshot' ? 'heapsnapshot' : 'cpuprofile';
+	const file = profileFilePath(scriptName, kind);
+
+	if (info && info.child && info.child.connected) {
+		info.child.send({ type: 'nue-agent', cmd, file });
+		return;
+	}
+
+	const label = scriptName || '';
+	let job;
+	if (cmd === 'profileStart') job = profiler.startCpuProfile().then(() => null);
+	else if (cmd === 'profileStop') job = profiler.stopCpuProfile(file);
+	else job = profiler.writeHeapSnapshot(file);
+
+	job.then((written) => {
+		if (written) {
+			plog(`Wrote ${written}`);
+			sendProfileResult(label, kind, written, '');
+		}
+	}).catch(e => sendProfileResult(label, kind, '', e.message));
+}
+
+function setStatsInterval(intervalMs) {
+	// Unchanged: keep the running samplers (and their sample phase) as they are.
+	if ((intervalMs > 0 ? intervalMs : 0) === statsIntervalMs) return;
+	statsIntervalMs = intervalMs > 0 ? intervalMs : 0;
+
+	if (stopBridgeSampler) { stopBridgeSampler(); stopBridgeSampler = null; }
+	if (statsIntervalMs > 0) {
+		stopBridgeSampler = profiler.startStatsSampler(statsIntervalMs, stats => sendStats('', stats));
+	}
+	for (const { child } of Object.values(activeChildren)) {
+		if (child.connected) child.send({ type: 'nue-agent', cmd: 'stats', intervalMs: statsIntervalMs });
+	}
+}
+
 // ---------------------------------------------------------------------------
 // Control command dispatch (from Unreal via CONTROL frames)
 // ---------------------------------------------------------------------------
@@ -502,6 +1256,51 @@ function handleControl(commandLine) {
 			autoResolveNpm = (args[0] === '1' || args[0] === 'true');
 			break;
 		}
+		case 'profile': {
+			const [action, scriptName] = args;
+			if (action === 'start') profileCommand('profileStart', scriptName);
+			else if (action === 'stop') profileCommand('profileStop', scriptName);
+			else plog('Usage: profile <start|stop> [scriptName]');
+			break;
+		}
+		case 'heapsnapshot': {
+			profileCommand('heapsnapshot', args[0]);
+			break;
+		}
+		case 'stats': {
+			setStatsInterval(parseInt(args[0], 10) || 0);
+			break;
+		}
+		case 'childPool': {
+			setChildPoolSize(parseInt(args[0], 10) || 0);
+			break;
+		}
+		case 'delta': {
+			const [name, interval] = args;
+			if (name) setDeltaInterval(name, parseInt(interval, 10) || 0);
+			else plog('Usage: delta <eventName> <keyframeInterval>');
+			break;
+		}
+		case 'keyframe': {
+			const [scriptName, name] = args;
+			if (name) requestKeyframe(scriptName, name);
+			break;
+		}
+		case 'trace': {
+			traceEnabled = (args[0] === '1' || args[0] === 'true');
+			break;
+		}
+		case 'streamWindow': {
+			const bytes = parseInt(args[0], 10);
+			if (bytes > 0) streamWindow = bytes;
+			break;
+		}
+		case 'frameLanes': {
+			const [threshold, size] = args.map(a => parseInt(a, 10));
+			if (threshold > 0) bulkThreshold = threshold;
+			if (size > 0) fragmentSize = size;
+			break;
+		}
 		case 'reloadComplete': {
 			// Unreal acked the reload; nothing further required.
 			break;
@@ -510,10 +1309,13 @@ function handleControl(commandLine) {
 			for (const [scriptName, { child }] of Object.entries(activeChildren)) {
 				try { child.kill(); } catch (e) { /* ignore */ }
 			}
+			for (const child of childPool) {
+				try { child.kill(); } catch (e) { /* ignore */ }
+			}
 			for (const watcher of Object.values(watchedScripts)) {
 				try { watcher.close(); } catch (e) { /* ignore */ }
 			}
-			process.exit(0);
+			flushLanesAndExit(0);
 			break;
 		}
 		default:
@@ -544,17 +1346,89 @@ function handleFrame(type, header, binary) {
 	if (type === T_CONTROL) {
 		handleControl(header);
 	} else if (type === T_EVENT) {
+		const receivedAt = nowMicros();
 		try {
 			const obj = JSON.parse(header);
 			const buffers = parseBinaryTable(binary);
 			const args = (obj.args || []).map(a => injectBinaries(a, buffers));
-			deliverEventToScript(obj.script || '', obj.name, args);
+			const trace = obj.trace ? { id: obj.trace.id, hops: [['handleFrame', receivedAt]] } : undefined;
+			if (Array.isArray(obj.scripts)) multicastEventToScripts(obj.scripts, obj.name, args, trace);
+			else deliverEventToScript(obj.script || '', obj.name, args, trace);
+			if (trace) writeFrame(T_TRACE, JSON.stringify(trace));
 		} catch (e) {
 			sendError('', 'event parse error: ' + e.message, e.stack);
 		}
+	} else if (type === T_TICK) {
+		try { handleTickFrame(header, binary); }
+		catch (e) { sendError('', 'tick parse error: ' + e.message, e.stack); }
+	} else if (type === T_STREAM) {
+		handleStreamFrame(header, binary);
+	} else if (type === T_FRAGMENT) {
+		handleFragment(binary);
 	}
 }
 
+// Decode one whole frame at `start`, or null if buf doesn't hold all of it yet.
+function decodeAt(buf, start) {
+	if (buf.length - start < 9) return null;
+	let p = start + 4;
+	const type = buf[p]; p += 1;
+	const headerLen = buf.readUInt32LE(p); p += 4;
+	if (buf.length < p + headerLen + 4) return null;
+	const header = buf.toString('utf8', p, p + headerLen); p += headerLen;
+	const binLen = buf.readUInt32LE(p); p += 4;
+	if (buf.length < p + binLen) return null;
+	const binary = Buffer.from(buf.subarray(p, p + binLen)); p += binLen;
+	return { type, header, binary, end: p };
+}
+
+// Fragment id -> { parts: [Buffer slices], bytes }. Bounded like the Unreal side
+// (FNodeFrameCodec): past the caps the least recently extended frame is evicted.
+// Map order is insertion order, and a touched entry is re-inserted, so the
+// first key is always the stalest.
+const stdinPartials = new Map();
+const MAX_PARTIAL_FRAMES = 16;
+const MAX_PARTIAL_BYTES = 1024 * 1024 * 1024;
+let stdinPartialBytes = 0;
+
+function dropPartial(id) {
+	const entry = stdinPartials.get(id);
+	if (!entry) return;
+	stdinPartialBytes -= entry.bytes;
+	stdinPartials.delete(id);
+}
+
+function handleFragment(binary) {
+	if (binary.length < 5) return;
+	const id = binary.readUInt32LE(0);
+	const last = (binary[4] & 0x01) !== 0;
+	const slice = binary.subarray(5);
+
+	let entry = stdinPartials.get(id);
+	if (entry) stdinPartials.delete(id);
+	else entry = { parts: [], bytes: 0 };
+	if (entry.bytes + slice.length > MAX_PARTIAL_BYTES) {
+		// A single frame over the cap can't be reassembled.
+		stdinPartialBytes -= entry.bytes;
+		return;
+	}
+	while (stdinPartials.size && (stdinPartials.size >= MAX_PARTIAL_FRAMES || stdinPartialBytes + slice.length > MAX_PARTIAL_BYTES)) {
+		dropPartial(stdinPartials.keys().next().value);
+	}
+	entry.parts.push(slice);
+	entry.bytes += slice.length;
+	stdinPartialBytes += slice.length;
+	if (!last) {
+		stdinPartials.set(id, entry);
+		return;
+	}
+
+	stdinPartialBytes -= entry.bytes;
+	const assembled = Buffer.concat(entry.parts);
+	const frame = matchMagic(assembled, 0) ? decodeAt(assembled, 0) : null;
+	if (frame) handleFrame(frame.type, frame.header, frame.binary);
+}
+
 function parseStdin() {
 	let cursor = 0;
 	while (true) {
@@ -567,17 +1441,11 @@ function parseStdin() {
 			continue;
 		}
 
-		let p = cursor + 4;
-		const type = stdinBuf[p]; p += 1;
-		const headerLen = stdinBuf.readUInt32LE(p); p += 4;
-		if (stdinBuf.length < p + headerLen + 4) break;
-		const header = stdinBuf.toString('utf8', p, p + headerLen); p += headerLen;
-		const binLen = stdinBuf.readUInt32LE(p); p += 4;
-		if (stdinBuf.length < p + binLen) break;
-		const binary = Buffer.from(stdinBuf.subarray(p, p + binLen)); p += binLen;
+		const frame = decodeAt(stdinBuf, cursor);
+		if (!frame) break;
 
-		handleFrame(type, header, binary);
-		cursor = p;
+		handleFrame(frame.type, frame.header, frame.binary);
+		cursor = frame.end;
 	}
 	if (cursor > 0) stdinBuf = Buffer.from(stdinBuf.subarray(cursor));
 }
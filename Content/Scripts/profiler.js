@@ -0,0 +1,90 @@
+/**
+ *  NodeJs-Unreal v2.0.0 - profiler.js
+ *
+ *  On-demand CPU profiles and heap snapshots through node's built-in inspector
+ *  session, plus event-loop delay / resource usage sampling. Used by process.js
+ *  for the bridge process (which hosts every inline script) and by childAgent.js
+ *  inside each subprocess script.
+ */
+
+const inspector = require('inspector');
+const fs = require('fs');
+const path = require('path');
+const { monitorEventLoopDelay } = require('perf_hooks');
+
+let session = null;
+let profiling = false;
+
+function post(method, params) {
+	if (!session) {
+		session = new inspector.Session();
+		session.connect();
+	}
+	return new Promise((resolve, reject) => {
+		session.post(method, params || {}, (err, result) => (err ? reject(err) : resolve(result)));
+	});
+}
+
+async function startCpuProfile() {
+	if (profiling) throw new Error('CPU profile already running');
+	await post('Profiler.enable');
+	await post('Profiler.start');
+	profiling = true;
+}
+
+// Resolves with the written path.
+async function stopCpuProfile(filePath) {
+	if (!profiling) throw new Error('no CPU profile running');
+	profiling = false;
+	const { profile } = await post('Profiler.stop');
+	await post('Profiler.disable');
+	fs.mkdirSync(path.dirname(filePath), { recursive: true });
+	fs.writeFileSync(filePath, JSON.stringify(profile));
+	return filePath;
+}
+
+// Streams the snapshot chunks straight to disk; resolves with the written path.
+async function writeHeapSnapshot(filePath) {
+	fs.mkdirSync(path.dirname(filePath), { recursive: true });
+	const fd = fs.openSync(filePath, 'w');
+	const onChunk = (m) => fs.writeSync(fd, m.params.chunk);
+	await post('HeapProfiler.enable');
+	session.on('HeapProfiler.addHeapSnapshotChunk', onChunk);
+	try {
+		await post('HeapProfiler.takeHeapSnapshot', { reportProgress: false });
+	} finally {
+		session.removeListener('HeapProfiler.addHeapSnapshotChunk', onChunk);
+		fs.closeSync(fd);
+	}
+	return filePath;
+}
+
+// Periodically calls onSample(stats) with event-loop delay percentiles (ms),
+// cpu time used since the previous sample (ms) and memory (bytes). Returns a stop fn.
+function startStatsSampler(intervalMs, onSample) {
+	const histogram = monitorEventLoopDelay({ resolution: 10 });
+	histogram.enable();
+	let lastUsage = process.resourceUsage();
+
+	const timer = setInterval(() => {
+		const usage = process.resourceUsage();
+		const mem = process.memoryUsage();
+		const ns = (v) => (Number.isFinite(v) ? v / 1e6 : 0);
+		onSample({
+			eventLoopDelay: {
+				min: ns(histogram.min), max: ns(histogram.max), mean: ns(histogram.mean),
+				p50: ns(histogram.percentile(50)), p99: ns(histogram.percentile(99)),
+			},
+			cpu: { user: (usage.userCPUTime - lastUsage.userCPUTime) / 1000, system: (usage.systemCPUTime - lastUsage.systemCPUTime) / 1000 },
+			memory: { rss: mem.rss, heapUsed: mem.heapUsed, heapTotal: mem.heapTotal, external: mem.external },
+		});
+		lastUsage = usage;
+		histogram.reset();
+	}, intervalMs);
+	// Sampling must never be the thing keeping a script alive.
+	timer.unref();
+
+	return () => { clearInterval(timer); histogram.disable(); };
+}
+
+module.exports = { startCpuProfile, stopCpuProfile, writeHeapSnapshot, startStatsSampler };
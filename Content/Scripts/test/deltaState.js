@@ -0,0 +1,18 @@
+// Delta event fixture for the test harness: every 'tick' re-emits a large
+// 'state' object in which only a couple of fields and a few buffer bytes change.
+
+const ipc = require('ipc-event-emitter').default(process);
+
+const entities = [];
+for (let i = 0; i < 200; i++) entities.push({ id: i, name: 'entity' + i, pos: { x: i, y: 0, z: 0 } });
+const pixels = Buffer.alloc(64 * 1024, 7);
+
+ipc.on('tick', (n) => {
+	entities[n % entities.length].pos.y = n;
+	pixels[n * 1000] = n & 0xff;
+	const state = { frame: n, entities, pixels };
+	if (n % 2) state.odd = true;
+	ipc.emit('state', state);
+});
+
+console.log('deltaState ready');
@@ -5,11 +5,26 @@
 //   1. inline adder round-trip       (myevent -> result)
 //   2. subprocess adder round-trip   (fork + real IPC channel)
 //   3. binary interweaving round-trip (binEcho echoes a Buffer unchanged)
+//   4. large-data throughput         (many binary frames from a subprocess)
+//   5. npm auto-resolve              (unlisted module warns, no install)
+//   6. path fallback                 (plugin Content/Scripts when project lacks the script)
+//   7. priority lanes: fragmented bulk frames both ways, small frames overtake bulk,
+//      queued frames still written out on exit
+//   8. streams: chunked transfers both ways with a bounded in-flight window
+//   9. tracing: node stamps hops of traced events and links replies to them
+//  10. profiling: cpu profile / heap snapshot files and runtime stats frames
+//  11. warm child pool: subprocess launches load into pre-forked children
+//  12. delta events: only changed paths / buffer ranges between keyframes
+//  13. lockstep: tick frames answered with tick results on the control lane
+//  14. multicast: one event frame fanned out to every matching script
+//  15. record/replay: a captured session replays through test/replay.js
 //
 // Run:  <bundled node.exe>  test\harness.js     (cwd = Content/Scripts)
 // Exit code 0 = all passed.
 
-const { spawn } = require('child_process');
+const { spawn, spawnSync } = require('child_process');
+const fs = require('fs');
+const os = require('os');
 const path = require('path');
 
 const SCRIPTS_DIR = path.resolve(__dirname, '..');
@@ -18,7 +33,8 @@ const PROCESS_JS = path.join(SCRIPTS_DIR, 'process.js');
 // ---- frame protocol (mirror of process.js) ----
 const MAGIC = Buffer.from([0x4E, 0x55, 0x45, 0x01]);
 const T_LOG = 0x01, T_ACTION = 0x02, T_EVENT = 0x03, T_ERROR = 0x04,
-	T_CONTROL = 0x05, T_PLOG = 0x06, T_NPM = 0x07;
+	T_CONTROL = 0x05, T_PLOG = 0x06, T_NPM = 0x07, T_FRAGMENT = 0x08, T_STREAM = 0x09,
+	T_TRACE = 0x0A, T_PROFILE = 0x0B, T_STATS = 0x0C, T_TICK = 0x0D, T_TICK_RESULT = 0x0E;
 
 function u32le(n) { const b = Buffer.alloc(4); b.writeUInt32LE(n >>> 0, 0); return b; }
 
@@ -41,9 +57,21 @@ function parseBinaryTable(buf) {
 	return out;
 }
 
+// Split an encoded frame into FRAGMENT frames of `size` payload bytes.
+function fragment(encoded, id, size) {
+	const out = [];
+	for (let off = 0; off < encoded.length; off += size) {
+		const end = Math.min(off + size, encoded.length);
+		const head = Buffer.alloc(5); head.writeUInt32LE(id, 0); head[4] = end >= encoded.length ? 1 : 0;
+		out.push(frame(T_FRAGMENT, '', Buffer.concat([head, encoded.subarray(off, end)])));
+	}
+	return out;
+}
+
 function controlFrame(line) { return frame(T_CONTROL, line); }
-function eventFrame(script, name, args, buffers) {
-	const header = JSON.stringify({ script, name, args });
+function streamFrame(header, chunk) { return frame(T_STREAM, JSON.stringify(header), chunk); }
+function eventFrame(script, name, args, buffers, trace) {
+	const header = JSON.stringify(trace ? { script, name, args, trace } : { script, name, args });
 	return frame(T_EVENT, header, buildBinaryTable(buffers || []));
 }
 
@@ -65,10 +93,23 @@ function waitFor(predicate, timeoutMs, label) {
 }
 
 let rxBuf = Buffer.alloc(0);
+const rxPartials = new Map();
 function matchMagic(buf, i) { return i + 4 <= buf.length && buf[i] === MAGIC[0] && buf[i + 1] === MAGIC[1] && buf[i + 2] === MAGIC[2] && buf[i + 3] === MAGIC[3]; }
 function findMagic(buf, start) { for (let i = start; i + 4 <= buf.length; i++) if (matchMagic(buf, i)) return i; return -1; }
 
+// Session capture in the .nuerec layout UNodeComponent records (section 15).
+let capture = null;
+function captureRecord(dir, bytes) {
+	if (!capture) return;
+	const head = Buffer.alloc(13);
+	head.writeBigUInt64LE(BigInt(Math.round(Number(process.hrtime.bigint() - capture.start) / 1000)), 0);
+	head[8] = dir;
+	head.writeUInt32LE(bytes.length, 9);
+	capture.parts.push(head, Buffer.from(bytes));
+}
+
 child.stdout.on('data', (chunk) => {
+	captureRecord(1, chunk);
 	rxBuf = Buffer.concat([rxBuf, chunk]);
 	let cursor = 0;
 	while (true) {
@@ -82,15 +123,30 @@ child.stdout.on('data', (chunk) => {
 		const bl = rxBuf.readUInt32LE(p); p += 4;
 		if (rxBuf.length < p + bl) break;
 		const binary = Buffer.from(rxBuf.subarray(p, p + bl)); p += bl;
-		dispatch(type, header, binary);
+		if (type === T_FRAGMENT) reassemble(binary); else dispatch(type, header, binary);
 		cursor = p;
 	}
 	if (cursor > 0) rxBuf = Buffer.from(rxBuf.subarray(cursor));
 });
 
+function reassemble(binary) {
+	const id = binary.readUInt32LE(0);
+	const parts = rxPartials.get(id) || [];
+	parts.push(binary.subarray(5));
+	rxPartials.set(id, parts);
+	if (!(binary[4] & 1)) return;
+	rxPartials.delete(id);
+	const whole = Buffer.concat(parts);
+	const hl = whole.readUInt32LE(5);
+	const header = whole.toString('utf8', 9, 9 + hl);
+	const bl = whole.readUInt32LE(9 + hl);
+	dispatch(whole[4], header, Buffer.from(whole.subarray(13 + hl, 13 + hl + bl)));
+}
+
 function dispatch(type, header, binary) {
-	const tag = { [T_LOG]: 'LOG', [T_PLOG]: 'PLOG', [T_ACTION]: 'ACTION', [T_EVENT]: 'EVENT', [T_ERROR]: 'ERROR', [T_NPM]: 'NPM' }[type] || ('0x' + type.toString(16));
+	const tag = { [T_LOG]: 'LOG', [T_PLOG]: 'PLOG', [T_ACTION]: 'ACTION', [T_EVENT]: 'EVENT', [T_ERROR]: 'ERROR', [T_NPM]: 'NPM', [T_STREAM]: 'STREAM', [T_TRACE]: 'TRACE', [T_PROFILE]: 'PROFILE', [T_STATS]: 'STATS', [T_TICK_RESULT]: 'TICK_RESULT' }[type] || ('0x' + type.toString(16));
 	let parsed = null;
+	if (type === T_STREAM || type === T_TRACE || type === T_PROFILE || type === T_STATS || type === T_TICK_RESULT) { try { parsed = JSON.parse(header); } catch (e) { /* */ } }
 	if (type === T_EVENT) { try { parsed = JSON.parse(header); parsed._buffers = parseBinaryTable(binary); } catch (e) { /* */ } }
 	console.error(`  <- ${tag} ${header.length > 120 ? header.slice(0, 120) + '...' : header}${binary.length ? ` [+${binary.length}b]` : ''}`);
 	const msg = { type, tag, header, binary, parsed };
@@ -99,7 +155,7 @@ function dispatch(type, header, binary) {
 	}
 }
 
-function send(buf) { child.stdin.write(buf); }
+function send(buf) { captureRecord(0, buf); child.stdin.write(buf); }
 const sleep = (ms) => new Promise(r => setTimeout(r, ms));
 
 let failures = 0;
@@ -183,8 +239,413 @@ async function run() {
 		check(Math.abs(m.parsed.args[0] - 17) < 1e-9, 'path fallback: script found under plugin Content/Scripts');
 	}
 
-	send(controlFrame('exit'));
-	await sleep(200);
+	// ---- 7) priority lanes: fragmented bulk in both directions ----
+	send(controlFrame('frameLanes 262144 65536'));
+	{
+		const big = Buffer.alloc(4 * 1024 * 1024);
+		for (let i = 0; i < big.length; i++) big[i] = (i * 31) & 0xFF;
+		const small = Buffer.from([7, 7, 7]);
+		const order = [];
+		const tracker = (m) => {
+			if (m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed') order.push(m.parsed.args[0].tag);
+			return false;
+		};
+		listeners.push({ predicate: tracker, resolve: () => {} });
+
+		// Interleave a small event between the fragments of the bulk one on the way in.
+		const frags = fragment(eventFrame('binEcho.js', 'echo', [{ tag: 'big' }, { _bin: 0 }], [big]), 4242, 65536);
+		send(Buffer.concat(frags.slice(0, 2)));
+		send(eventFrame('binEcho.js', 'echo', [{ tag: 'small' }, { _bin: 0 }], [small]));
+		send(Buffer.concat(frags.slice(2)));
+
+		const m = await waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed' && m.parsed.args[0].tag === 'big', 10000, 'bulk echo');
+		check(m.parsed._buffers.length === 1 && m.parsed._buffers[0].equals(big), 'priority lanes: 4 MB fragmented echo matches byte-for-byte');
+
+		// Both queued in one tick on the node side; the small echo must not wait behind the bulk one.
+		send(Buffer.concat([
+			eventFrame('binEcho.js', 'echo', [{ tag: 'big2' }, { _bin: 0 }], [big]),
+			eventFrame('binEcho.js', 'echo', [{ tag: 'small2' }, { _bin: 0 }], [small]),
+		]));
+		await waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed' && m.parsed.args[0].tag === 'big2', 10000, 'bulk echo 2');
+		check(order.indexOf('small') !== -1 && order.indexOf('small') < order.indexOf('big'), 'priority lanes: small event between inbound fragments delivered first');
+		check(order.indexOf('small2') !== -1 && order.indexOf('small2') < order.indexOf('big2'), 'priority lanes: small outbound event overtakes bulk transfer');
+		listeners.splice(listeners.findIndex(l => l.predicate === tracker), 1);
+	}
+
+	// ---- 8) streams ----
+	{
+		const WINDOW = 1024 * 1024, CHUNK = 256 * 1024, COUNT = 32;
+		send(controlFrame('streamWindow ' + WINDOW));
+		send(controlFrame('scriptsPath ' + SCRIPTS_DIR + path.sep));
+		send(controlFrame('launchInline streamEcho.js examples' + path.sep));
+		await waitFor(m => m.type === T_LOG && m.header.includes('streamEcho ready'), 5000, 'streamEcho started');
+
+		// Unreal -> script: acks must come back and the script must see every byte.
+		let acked = 0;
+		const ackWatch = { predicate: (m) => { if (m.type === T_STREAM && m.parsed.op === 'ack' && m.parsed.id === 7) acked += m.parsed.bytes; return false; }, resolve: () => {} };
+		listeners.push(ackWatch);
+		send(streamFrame({ op: 'open', id: 7, script: 'streamEcho.js', name: 'upload', size: CHUNK * 8 }));
+		for (let i = 0; i < 8; i++) send(streamFrame({ op: 'data', id: 7 }, Buffer.alloc(CHUNK, i)));
+		send(streamFrame({ op: 'end', id: 7, total: CHUNK * 8 }));
+		const up = await waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'uploaded', 5000, 'upload done');
+		check(up.parsed.args[0].total === CHUNK * 8, 'streams: script read every uploaded byte');
+		await sleep(50);
+		check(acked === CHUNK * 8, `streams: node acked all uploaded bytes (${acked})`);
+		listeners.splice(listeners.indexOf(ackWatch), 1);
+
+		// Script -> Unreal: ack slowly and make sure node never exceeds the window,
+		// also with a chunk size that doesn't divide it evenly.
+		async function download(chunkSize, label) {
+			let received = 0, inFlight = 0, maxInFlight = 0, streamId = -1;
+			const downWatch = {
+				predicate: (m) => {
+					if (m.type !== T_STREAM || !m.parsed) return false;
+					if (m.parsed.op === 'open' && m.parsed.name === 'download') streamId = m.parsed.id;
+					if (m.parsed.op === 'data' && m.parsed.id === streamId) {
+						received += m.binary.length;
+						inFlight += m.binary.length;
+						maxInFlight = Math.max(maxInFlight, inFlight);
+						const n = m.binary.length;
+						setTimeout(() => { inFlight -= n; send(streamFrame({ op: 'ack', id: streamId, bytes: n })); }, 5);
+					}
+					return false;
+				},
+				resolve: () => {},
+			};
+			listeners.push(downWatch);
+			send(eventFrame('streamEcho.js', 'download', [{ size: chunkSize, count: COUNT }]));
+			const end = await waitFor(m => m.type === T_STREAM && m.parsed && m.parsed.op === 'end' && m.parsed.id === streamId, 10000, 'download end');
+			check(received === chunkSize * COUNT && end.parsed.total === chunkSize * COUNT, `streams: received all ${chunkSize * COUNT} streamed bytes${label} (${received})`);
+			check(maxInFlight <= WINDOW, `streams: unacked bytes stayed within the window${label} (max ${maxInFlight})`);
+			listeners.splice(listeners.indexOf(downWatch), 1);
+		}
+		await download(CHUNK, '');
+		await download(300 * 1024, ', 300 KB chunks');
+	}
+
+	// ---- 9) tracing ----
+	send(controlFrame('trace 1'));
+	{
+		const traced = waitFor(m => m.type === T_TRACE && m.parsed && m.parsed.id === 5, 5000, 'trace frame');
+		const echoed = waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed' && m.parsed.args[0].tag === 'traced', 5000, 'traced echo');
+		const traceFrames = [];
+		const traceWatch = { predicate: (m) => { if (m.type === T_TRACE && m.parsed) traceFrames.push(m.parsed); return false; }, resolve: () => {} };
+		listeners.push(traceWatch);
+		send(eventFrame('binEcho.js', 'echo', [{ tag: 'traced' }, { _bin: 0 }], [Buffer.from([1])], { id: 5 }));
+
+		const t = (await traced).parsed;
+		const stages = t.hops.map(h => h[0]).join(',');
+		const ordered = t.hops.every((h, i) => i === 0 || h[1] >= t.hops[i - 1][1]);
+		check(stages === 'handleFrame,deliver,handled' && ordered, `tracing: node reported ordered hops (${stages})`);
+
+		const e = (await echoed).parsed;
+		check(e.trace && e.trace.parent === 5 && e.trace.hops.map(h => h[0]).join(',') === 'emit', 'tracing: reply carries its own hops and the parent id');
+		await sleep(50);
+		listeners.splice(listeners.indexOf(traceWatch), 1);
+		const written = traceFrames.find(t => e.trace && t.id === e.trace.id);
+		check(written && written.hops.length === 1 && written.hops[0][0] === 'write' && written.hops[0][1] >= e.trace.hops[0][1],
+			'tracing: reply reports a write hop once it is on the pipe');
+
+		// Subprocess target: the bridge reports up to 'deliver', the child's agent adds receive/handled.
+		const childHops = [];
+		const childWatch = { predicate: (m) => { if (m.type === T_TRACE && m.parsed && m.parsed.id === 6) childHops.push(...m.parsed.hops); return false; }, resolve: () => {} };
+		listeners.push(childWatch);
+		send(eventFrame('perfStream.js', 'start', [{ size: 16, count: 1 }], [], { id: 6 }));
+		for (let waited = 0; !childHops.some(h => h[0] === 'handled') && waited < 5000; waited += 20) await sleep(20);
+		listeners.splice(listeners.indexOf(childWatch), 1);
+		childHops.sort((x, y) => x[1] - y[1]);
+		const childStages = childHops.map(h => h[0]).join(',');
+		check(childStages === 'handleFrame,deliver,receive,handled', `tracing: subprocess delivery reports receive and handled hops (${childStages})`);
+	}
+	send(controlFrame('trace 0'));
+
+	// ---- 10) profiling & runtime stats ----
+	{
+		// Profiles land under <scriptRoot>/Saved; keep them out of the tree.
+		const profileRoot = fs.mkdtempSync(path.join(os.tmpdir(), 'nue-harness-'));
+		send(controlFrame('scriptsPath ' + profileRoot + path.sep));
+
+		send(controlFrame('profile start'));
+		await sleep(100);
+		send(controlFrame('profile stop'));
+		const cpu = (await waitFor(m => m.type === T_PROFILE && m.parsed && m.parsed.kind === 'cpuprofile', 10000, 'cpu profile')).parsed;
+		check(!cpu.error && fs.existsSync(cpu.path) && JSON.parse(fs.readFileSync(cpu.path, 'utf8')).nodes.length > 0, 'profiling: bridge .cpuprofile written');
+
+		send(controlFrame('heapsnapshot perfStream.js'));
+		const heap = (await waitFor(m => m.type === T_PROFILE && m.parsed && m.parsed.kind === 'heapsnapshot', 20000, 'heap snapshot')).parsed;
+		check(!heap.error && heap.script === 'perfStream.js' && fs.existsSync(heap.path) && fs.statSync(heap.path).size > 0, 'profiling: subprocess .heapsnapshot written by the child');
+
+		const seen = new Set();
+		const statsWatch = { predicate: (m) => { if (m.type === T_STATS && m.parsed) seen.add(m.parsed.script); return false; }, resolve: () => {} };
+		listeners.push(statsWatch);
+		send(controlFrame('stats 50'));
+		const st = (await waitFor(m => m.type === T_STATS && m.parsed && m.parsed.script === '', 5000, 'bridge stats')).parsed;
+		check(st.eventLoopDelay && typeof st.eventLoopDelay.p99 === 'number' && st.memory.heapUsed > 0, 'profiling: bridge reports event-loop delay and memory');
+		await waitFor(m => m.type === T_STATS && m.parsed && m.parsed.script === 'perfStream.js', 5000, 'child stats');
+		check(seen.has('perfStream.js'), 'profiling: subprocess reports its own stats');
+		send(controlFrame('stats 0'));
+		listeners.splice(listeners.indexOf(statsWatch), 1);
+
+		fs.rmSync(profileRoot, { recursive: true, force: true });
+	}
+
+	// ---- 11) warm child pool ----
+	{
+		send(controlFrame('scriptsPath ' + SCRIPTS_DIR + path.sep));
+		send(controlFrame('stop binEcho.js'));
+		send(controlFrame('childPool 1'));
+		await sleep(500);
+
+		let t0 = Date.now();
+		send(controlFrame('launchSubprocess binEcho.js examples' + path.sep));
+		const launched = await waitFor(m => m.type === T_PLOG && m.header.includes('child process for "binEcho.js"'), 5000, 'pooled launch');
+		await waitFor(m => m.type === T_LOG && m.header.includes('binEcho ready'), 5000, 'pooled binEcho ready');
+		const warmMs = Date.now() - t0;
+		check(launched.header.includes('warm'), 'pool: launch took a pre-forked child');
+
+		const payload = Buffer.from('warm pool payload');
+		send(eventFrame('binEcho.js', 'echo', [{ n: 1 }, { _bin: 0 }], [payload]));
+		const echoed = await waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed' && m.parsed.script === 'binEcho.js', 5000, 'pooled echo');
+		check(echoed.parsed._buffers.length === 1 && echoed.parsed._buffers[0].equals(payload), 'pool: pooled child runs the script with IPC and binary intact');
+
+		// Missing script: nothing ran, so the child goes back to the pool.
+		send(controlFrame('launchSubprocess doesNotExist.js examples' + path.sep));
+		const err = await waitFor(m => m.type === T_ERROR && m.header.includes('doesNotExist.js'), 5000, 'pooled load failure');
+		check(/Cannot find module/.test(err.header), 'pool: unresolvable script reported as an error');
+
+		send(controlFrame('stop binEcho.js'));
+		await sleep(500);
+		t0 = Date.now();
+		send(controlFrame('launchSubprocess binEcho.js examples' + path.sep));
+		const relaunched = await waitFor(m => m.type === T_PLOG && m.header.includes('child process for "binEcho.js"'), 5000, 'pooled relaunch');
+		await waitFor(m => m.type === T_LOG && m.header.includes('binEcho ready'), 5000, 'pooled relaunch ready');
+		check(relaunched.header.includes('warm'), 'pool: refilled in the background for the next launch');
+		console.error(`  warm launch ${warmMs} ms, relaunch ${Date.now() - t0} ms`);
+
+		send(controlFrame('stop binEcho.js'));
+		send(controlFrame('childPool 0'));
+	}
+
+	// ---- 12) delta-encoded state events ----
+	{
+		// Receiver mirror of UNodeComponent's delta reconstruction.
+		let held = null;
+		function applyDelta(m) {
+			const d = m.parsed.delta;
+			const table = m.parsed._buffers;
+			if (d.key) {
+				held = { seq: d.seq, args: m.parsed.args, buffers: table.map(b => Buffer.from(b)) };
+			} else {
+				if (!held || d.base !== held.seq) return null;
+				for (const op of d.ops) {
+					let node = { root: held.args };
+					const keys = ['root', ...op[1]];
+					for (let i = 0; i < keys.length - 1; i++) node = node[keys[i]];
+					if (op[0] === 's') node[keys[keys.length - 1]] = op[2];
+					else delete node[keys[keys.length - 1]];
+				}
+				held.buffers.length = d.bufs;
+				for (const [i, offset, t] of d.bins) {
+					if (offset < 0) held.buffers[i] = Buffer.from(table[t]);
+					else table[t].copy(held.buffers[i], offset);
+				}
+				held.seq = d.seq;
+			}
+			const state = held.args[0];
+			return { frame: state.frame, y: state.entities.map(e => e.pos.y), odd: !!state.odd, pixels: held.buffers[state.pixels._bin] };
+		}
+
+		const expectPixels = Buffer.alloc(64 * 1024, 7);
+		const expectY = new Array(200).fill(0);
+		const frames = [];
+		let allMatch = true;
+		async function tick(n) {
+			send(eventFrame('deltaState.js', 'tick', [n]));
+			const m = await waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'state', 5000, 'state ' + n);
+			expectY[n % 200] = n;
+			expectPixels[n * 1000] = n & 0xff;
+			const got = applyDelta(m);
+			const ok = got && got.frame === n && got.odd === !!(n % 2) && got.pixels.equals(expectPixels) && got.y.every((y, i) => y === expectY[i]);
+			if (!ok) allMatch = false;
+			frames.push({ key: !!m.parsed.delta.key, size: m.header.length + m.binary.length });
+		}
+
+		send(controlFrame('delta state 4'));
+		send(controlFrame('launchInline deltaState.js test' + path.sep));
+		await waitFor(m => m.type === T_LOG && m.header.includes('deltaState ready'), 5000, 'deltaState ready');
+		for (let n = 1; n <= 6; n++) await tick(n);
+		send(controlFrame('keyframe deltaState.js state'));
+		await tick(7);
+
+		check(allMatch, 'delta: receiver rebuilt every full state exactly');
+		check(frames.map(f => f.key ? 'K' : 'd').join('') === 'KdddKdK', 'delta: keyframe every 4 updates and on request (' + frames.map(f => f.key ? 'K' : 'd').join('') + ')');
+		check(frames[1].size * 20 < frames[0].size, `delta: delta frames much smaller than keyframes (${frames[1].size} vs ${frames[0].size} bytes)`);
+
+		// With a low bulk threshold the keyframe is fragmented on the bulk lane while the
+		// small deltas emitted right after it would fit the event lane; they must not overtake it.
+		send(controlFrame('frameLanes 16384 4096'));
+		const burst = [];
+		const burstWatch = { predicate: (m) => { if (m.type === T_EVENT && m.parsed && m.parsed.name === 'state') burst.push(m); return false; }, resolve: () => {} };
+		listeners.push(burstWatch);
+		send(Buffer.concat([controlFrame('keyframe deltaState.js state'), ...[8, 9, 10].map(n => eventFrame('deltaState.js', 'tick', [n]))]));
+		for (let waited = 0; burst.length < 3 && waited < 5000; waited += 20) await sleep(20);
+		listeners.splice(listeners.indexOf(burstWatch), 1);
+		let burstOk = burst.length === 3 && !!burst[0].parsed.delta.key;
+		for (let i = 0; i < burst.length && burstOk; i++) {
+			const n = 8 + i;
+			expectY[n % 200] = n;
+			expectPixels[n * 1000] = n & 0xff;
+			const got = applyDelta(burst[i]);
+			burstOk = !!got && got.frame === n && got.pixels.equals(expectPixels) && got.y.every((y, j) => y === expectY[j]);
+		}
+		check(burstOk, 'delta: small deltas stay behind the fragmented keyframe they build on (' + burst.map(m => m.parsed.delta.key ? 'K' : 'd').join('') + ')');
+		send(controlFrame('frameLanes 262144 65536'));
+		send(controlFrame('delta state 0'));
+		send(controlFrame('stop deltaState.js'));
+	}
+
+	// ---- 13) lockstep ticks ----
+	{
+		send(controlFrame('launchInline lockstep.js test' + path.sep));
+		await waitFor(m => m.type === T_LOG && m.header.includes('lockstep ready'), 5000, 'lockstep ready');
+
+		const tickFrame = (frameNo, dt, inputs, buffers) => frame(T_TICK,
+			JSON.stringify({ script: 'lockstep.js', frame: frameNo, dt, name: 'tick', reply: 'tickResult', inputs }),
+			buildBinaryTable(buffers || []));
+
+		let sawEvent = false;
+		const eventWatch = { predicate: (m) => { if (m.type === T_EVENT && m.parsed && m.parsed.name === 'tickResult') sawEvent = true; return false; }, resolve: () => {} };
+		listeners.push(eventWatch);
+
+		const t0 = process.hrtime.bigint();
+		send(tickFrame(1, 0.016, [1, 2, { _bin: 0 }], [Buffer.alloc(100)]));
+		const r1 = (await waitFor(m => m.type === T_TICK_RESULT && m.parsed && m.parsed.frame === 1, 5000, 'tick 1 result')).parsed;
+		const roundTripUs = Number(process.hrtime.bigint() - t0) / 1000;
+		check(r1.script === 'lockstep.js' && r1.args[0].sum === 3 && r1.args[0].bytes === 100 && r1.args[0].dt === 0.016, 'lockstep: tick delivered with dt and inputs, answered as TICK_RESULT');
+		console.error(`  lockstep round trip ${roundTripUs.toFixed(0)} us`);
+
+		send(tickFrame(2, 0.016, [{ defer: 20 }, 5]));
+		const r2 = (await waitFor(m => m.type === T_TICK_RESULT && m.parsed && m.parsed.frame === 2, 5000, 'tick 2 result')).parsed;
+		check(r2.args[0].sum === 5, 'lockstep: asynchronous answer still tagged with its frame');
+
+		// Tick 4 supersedes tick 3 before 3's deferred answer arrives: 4 gets its own
+		// answer and 3's late one is dropped rather than relabelled.
+		const results = [];
+		const resultWatch = { predicate: (m) => { if (m.type === T_TICK_RESULT && m.parsed) results.push(m.parsed); return false; }, resolve: () => {} };
+		listeners.push(resultWatch);
+		send(tickFrame(3, 0.016, [{ defer: 40 }, 30]));
+		await sleep(5);
+		send(tickFrame(4, 0.016, [40]));
+		await sleep(150);
+		listeners.splice(listeners.indexOf(resultWatch), 1);
+		check(results.length === 1 && results[0].frame === 4 && results[0].args[0].sum === 40,
+			'lockstep: overlapping ticks pair each result with its own frame, superseded answer dropped');
+
+		listeners.splice(listeners.indexOf(eventWatch), 1);
+		check(!sawEvent, 'lockstep: tick results are not also sent as events');
+		send(controlFrame('stop lockstep.js'));
+	}
+
+	// ---- 14) multicast events ----
+	{
+		send(controlFrame('launchInline multicastSink.js test' + path.sep));
+		await waitFor(m => m.type === T_LOG && m.header.includes('multicastSink ready'), 5000, 'multicastSink ready');
+		send(controlFrame('launchSubprocess binEcho.js examples' + path.sep));
+		await waitFor(m => m.type === T_LOG && m.header.includes('binEcho ready'), 5000, 'binEcho child ready');
+
+		const multicast = (scripts, meta, buf) => frame(T_EVENT,
+			JSON.stringify({ scripts, name: 'echo', args: [meta, { _bin: 0 }] }), buildBinaryTable([buf]));
+		const echoesFrom = (tag, count) => {
+			const from = new Set();
+			return waitFor(m => {
+				if (m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed' && m.parsed.args[0].tag === tag
+					&& m.parsed._buffers[0] && m.parsed._buffers[0].length === 4096) from.add(m.parsed.script);
+				return from.size >= count;
+			}, 5000, 'multicast ' + tag).then(() => from);
+		};
+
+		const blob = Buffer.alloc(4096, 0x5a);
+		let pending = echoesFrom('list', 2);
+		send(multicast(['binEcho.js', 'multicast*'], { tag: 'list' }, blob));
+		let from = await pending;
+		check(from.has('binEcho.js') && from.has('multicastSink.js'), 'multicast: pattern list reached the inline and the subprocess script');
+
+		pending = echoesFrom('all', 2);
+		send(multicast([], { tag: 'all' }, blob));
+		from = await pending;
+		check(from.has('binEcho.js') && from.has('multicastSink.js'), 'multicast: empty target list reaches every running script');
+
+		// Traced multicast: one track per target, each parented to the multicast's id.
+		const targetTraces = [];
+		const targetWatch = { predicate: (m) => { if (m.type === T_TRACE && m.parsed && m.parsed.parent === 9) targetTraces.push(m.parsed); return false; }, resolve: () => {} };
+		listeners.push(targetWatch);
+		const fanout = waitFor(m => m.type === T_TRACE && m.parsed && m.parsed.id === 9, 5000, 'multicast trace');
+		pending = echoesFrom('traced', 2);
+		send(frame(T_EVENT, JSON.stringify({ scripts: ['binEcho.js', 'multicast*'], name: 'echo', args: [{ tag: 'traced' }, { _bin: 0 }], trace: { id: 9 } }), buildBinaryTable([blob])));
+		const fanoutStages = (await fanout).parsed.hops.map(h => h[0]).join(',');
+		await pending;
+		listeners.splice(listeners.indexOf(targetWatch), 1);
+		const byScript = Object.fromEntries(targetTraces.map(t => [t.script, t]));
+		check(fanoutStages === 'handleFrame,fanout', `multicast: traced frame reports its own hops (${fanoutStages})`);
+		check(targetTraces.length === 2 && byScript['binEcho.js'] && byScript['multicastSink.js'] && byScript['binEcho.js'].id !== byScript['multicastSink.js'].id
+			&& byScript['multicastSink.js'].hops.map(h => h[0]).join(',') === 'deliver,handled'
+			&& byScript['binEcho.js'].hops.map(h => h[0]).join(',') === 'deliver',
+			'multicast: each target traced under its own id');
+
+		send(multicast(['nothing*'], { tag: 'none' }, blob));
+		const miss = await waitFor(m => m.type === T_PLOG && m.header.includes('No running script matches'), 5000, 'multicast miss');
+		check(miss.header.includes('nothing*'), 'multicast: unmatched pattern reported');
+
+		send(controlFrame('stop binEcho.js'));
+		send(controlFrame('stop multicastSink.js'));
+	}
+
+	// ---- 15) record / replay round trip ----
+	{
+		await sleep(300); // let the previous section's children finish exiting before capturing
+		let framesIn = 0;
+		const frameWatch = { predicate: () => { framesIn++; return false; }, resolve: () => {} };
+		capture = { start: process.hrtime.bigint(), parts: [Buffer.from([0x4E, 0x55, 0x45, 0x52, 1, 0, 0, 0])] };
+		listeners.push(frameWatch);
+
+		send(controlFrame('scriptsPath ' + SCRIPTS_DIR + path.sep));
+		send(controlFrame('launchInline binEcho.js examples' + path.sep));
+		await waitFor(m => m.type === T_LOG && m.header.includes('binEcho ready'), 5000, 'binEcho ready for capture');
+		const blob = Buffer.alloc(600 * 1024, 0x42); // fragmented both ways
+		send(eventFrame('binEcho.js', 'echo', [{ tag: 'rec' }, { _bin: 0 }], [blob]));
+		await waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed' && m.parsed.args[0].tag === 'rec', 5000, 'captured echo');
+		send(controlFrame('stop binEcho.js'));
+		await waitFor(m => m.type === T_ACTION && m.header.startsWith('end ') && m.header.includes('binEcho.js'), 5000, 'captured stop');
+
+		listeners.splice(listeners.indexOf(frameWatch), 1);
+		const recFile = path.join(os.tmpdir(), `nue-harness-${process.pid}.nuerec`);
+		fs.writeFileSync(recFile, Buffer.concat(capture.parts));
+		capture = null;
+
+		const replay = (mode) => spawnSync(process.execPath, [path.join(__dirname, 'replay.js'), recFile, mode, '--fast', '--cwd', SCRIPTS_DIR],
+			{ encoding: 'utf8', env: process.env, timeout: 20000 }).stdout || '';
+
+		const decoded = /decode: (\d+) records, (\d+) frames/.exec(replay('decode'));
+		check(decoded && Number(decoded[2]) === framesIn, `record/replay: decode replays every captured frame (${decoded ? decoded[2] : '?'} of ${framesIn})`);
+
+		const bridged = /bridge: (\d+) records in, (\d+) frames \/ ([\d.]+) MB out/.exec(replay('bridge'));
+		check(bridged && Number(bridged[2]) >= framesIn && Number(bridged[3]) >= 0.5,
+			`record/replay: captured input replayed into a fresh bridge reproduces the session (${bridged ? bridged[2] : '?'} frames)`);
+		fs.rmSync(recFile, { force: true });
+	}
+
+	// ---- exit flushes queued lanes ----
+	{
+		send(controlFrame('launchInline binEcho.js examples' + path.sep));
+		await waitFor(m => m.type === T_LOG && m.header.includes('binEcho ready'), 5000, 'binEcho ready before exit');
+		const exited = new Promise(resolve => child.once('exit', resolve));
+		// The echo is queued on the bulk lane when exit arrives in the same write.
+		send(Buffer.concat([eventFrame('binEcho.js', 'echo', [{ tag: 'last' }, { _bin: 0 }], [Buffer.alloc(600 * 1024, 0x43)]), controlFrame('exit')]));
+		const last = await waitFor(m => m.type === T_EVENT && m.parsed && m.parsed.name === 'echoed' && m.parsed.args[0].tag === 'last', 5000, 'echo flushed on exit')
+			.catch(() => null);
+		check(last && last.parsed._buffers.length === 1 && last.parsed._buffers[0].length === 600 * 1024, 'lanes: exit writes out frames still queued on the bulk lane');
+		await Promise.race([exited, sleep(3000)]);
+	}
 }
 
 run()
@@ -0,0 +1,19 @@
+// Lockstep fixture for the test harness: answers every tick with the sum of
+// its numeric inputs and the total size of any input buffers. An input of
+// { defer: ms } answers asynchronously after that long.
+
+const ipc = require('ipc-event-emitter').default(process);
+
+ipc.on('tick', (dt, inputs, frame) => {
+	let sum = 0, bytes = 0, defer = 0;
+	for (const input of inputs) {
+		if (typeof input === 'number') sum += input;
+		else if (Buffer.isBuffer(input)) bytes += input.length;
+		else if (input && input.defer) defer = input.defer;
+	}
+	const answer = () => ipc.emit('tickResult', { frame, dt, sum, bytes });
+	if (defer) setTimeout(answer, defer);
+	else answer();
+});
+
+console.log('lockstep ready');
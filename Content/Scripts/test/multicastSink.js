@@ -0,0 +1,10 @@
+// Multicast fixture for the test harness: answers 'echo' like examples/binEcho.js,
+// so one multicast frame can be checked against an inline and a subprocess script.
+
+const ipc = require('ipc-event-emitter').default(process);
+
+ipc.on('echo', (meta, buf) => {
+	ipc.emit('echoed', meta, buf);
+});
+
+console.log('multicastSink ready');
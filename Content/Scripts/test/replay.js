@@ -0,0 +1,138 @@
+// Offline replay / benchmark for .nuerec frame stream recordings made by
+// UNodeComponent (bRecordFrameStream or StartStreamRecording).
+//
+// Modes:
+//   decode  : run the node->UE side through a frame decoder and report
+//             frames/s and MB/s (no process, no engine).
+//   bridge  : spawn process.js and feed it the UE->node side, reporting what
+//             comes back. Use --cwd to run it where the recorded scriptsPath
+//             resolves (defaults to Content/Scripts).
+//
+// Run:  node test\replay.js <file.nuerec> [decode|bridge] [--fast] [--cwd <dir>]
+// --fast plays records back to back instead of at their recorded timing.
+//
+// Node has no memory-mapping API, so the file is read into one Buffer up front
+// and records are played from subarray views of it (no per-record copies).
+
+const { spawn } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const SCRIPTS_DIR = path.resolve(__dirname, '..');
+const PROCESS_JS = path.join(SCRIPTS_DIR, 'process.js');
+
+const REC_MAGIC = Buffer.from('NUER', 'latin1');
+const DIR_TO_NODE = 0, DIR_FROM_NODE = 1;
+
+const MAGIC = Buffer.from([0x4E, 0x55, 0x45, 0x01]);
+const T_FRAGMENT = 0x08;
+
+function readRecords(file) {
+	const data = fs.readFileSync(file);
+	if (data.length < 8 || !data.subarray(0, 4).equals(REC_MAGIC) || data[4] !== 1) {
+		throw new Error(file + ' is not a NodeJs stream recording');
+	}
+	const records = [];
+	let off = 8;
+	while (off + 13 <= data.length) {
+		const micros = Number(data.readBigUInt64LE(off));
+		const dir = data[off + 8];
+		const len = data.readUInt32LE(off + 9);
+		off += 13;
+		if (off + len > data.length) break; // truncated tail
+		records.push({ micros, dir, bytes: data.subarray(off, off + len) });
+		off += len;
+	}
+	return records;
+}
+
+// Feed records of one direction to sink, honouring recorded gaps unless fast.
+async function play(records, dir, fast, sink) {
+	const start = process.hrtime.bigint();
+	let played = 0;
+	for (const r of records) {
+		if (r.dir !== dir) continue;
+		if (!fast) {
+			const wait = r.micros - Number(process.hrtime.bigint() - start) / 1000;
+			if (wait > 1000) await new Promise(res => setTimeout(res, Math.floor(wait / 1000)));
+		}
+		sink(r.bytes);
+		played++;
+	}
+	return played;
+}
+
+// Minimal incremental decoder (mirror of FNodeFrameCodec) that counts frames.
+function makeDecoder(onFrame) {
+	let buf = Buffer.alloc(0);
+	const partials = new Map();
+	function emit(type, header, binary) {
+		if (type !== T_FRAGMENT) { onFrame(type, header, binary); return; }
+		const id = binary.readUInt32LE(0);
+		const parts = partials.get(id) || [];
+		parts.push(binary.subarray(5));
+		partials.set(id, parts);
+		if (!(binary[4] & 1)) return;
+		partials.delete(id);
+		decodeAll(Buffer.concat(parts), emit);
+	}
+	function decodeAll(b, cb) {
+		let c = 0;
+		while (b.length - c >= 9) {
+			if (!b.subarray(c, c + 4).equals(MAGIC)) { c++; continue; }
+			const hl = b.readUInt32LE(c + 5);
+			if (b.length < c + 9 + hl + 4) break;
+			const bl = b.readUInt32LE(c + 9 + hl);
+			if (b.length < c + 13 + hl + bl) break;
+			cb(b[c + 4], b.toString('utf8', c + 9, c + 9 + hl), b.subarray(c + 13 + hl, c + 13 + hl + bl));
+			c += 13 + hl + bl;
+		}
+		return c;
+	}
+	return (chunk) => {
+		buf = buf.length ? Buffer.concat([buf, chunk]) : chunk;
+		const used = decodeAll(buf, emit);
+		buf = buf.subarray(used);
+	};
+}
+
+async function runDecode(records, fast) {
+	let frames = 0, bytes = 0;
+	const feed = makeDecoder(() => { frames++; });
+	const t0 = process.hrtime.bigint();
+	const played = await play(records, DIR_FROM_NODE, fast, (b) => { bytes += b.length; feed(b); });
+	const ms = Number(process.hrtime.bigint() - t0) / 1e6;
+	console.log(`decode: ${played} records, ${frames} frames, ${(bytes / 1048576).toFixed(2)} MB in ${ms.toFixed(2)} ms`
+		+ ` (${(frames / (ms / 1000)).toFixed(0)} frames/s, ${((bytes / 1048576) / (ms / 1000)).toFixed(1)} MB/s)`);
+}
+
+async function runBridge(records, fast, cwd) {
+	const child = spawn(process.execPath, [PROCESS_JS], { cwd, stdio: ['pipe', 'pipe', 'inherit'] });
+	let frames = 0, bytes = 0;
+	const feed = makeDecoder(() => { frames++; });
+	child.stdout.on('data', (chunk) => { bytes += chunk.length; feed(chunk); });
+
+	const t0 = process.hrtime.bigint();
+	const played = await play(records, DIR_TO_NODE, fast, (b) => child.stdin.write(b));
+	// Give the bridge a moment to finish answering before tearing it down.
+	await new Promise(res => setTimeout(res, 500));
+	const ms = Number(process.hrtime.bigint() - t0) / 1e6;
+	console.log(`bridge: ${played} records in, ${frames} frames / ${(bytes / 1048576).toFixed(2)} MB out in ${ms.toFixed(2)} ms`);
+	child.kill();
+}
+
+const args = process.argv.slice(2);
+const cwdIdx = args.indexOf('--cwd');
+const cwd = cwdIdx >= 0 ? path.resolve(args[cwdIdx + 1]) : SCRIPTS_DIR;
+const file = args.find((a, i) => !a.startsWith('--') && (cwdIdx < 0 || i !== cwdIdx + 1) && a !== 'decode' && a !== 'bridge');
+const mode = args.includes('bridge') ? 'bridge' : 'decode';
+const fast = args.includes('--fast');
+
+if (!file) {
+	console.log('Usage: node test/replay.js <file.nuerec> [decode|bridge] [--fast] [--cwd <dir>]');
+	process.exit(1);
+}
+
+const records = readRecords(file);
+(mode === 'bridge' ? runBridge(records, fast, cwd) : runDecode(records, fast))
+	.catch((e) => { console.error('REPLAY ERROR: ' + e.message); process.exit(2); });
@@ -4,6 +4,8 @@
 #include "Async/Async.h"
 #include "Runtime/Core/Public/Misc/Paths.h"
 #include "Json.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Misc/ScopeExit.h"
 
 //~ Script control ---------------------------------------------------------
 
@@ -11,6 +13,12 @@ bool UNodeComponent::StartScript(const FNodeJsScriptParams& ScriptParams)
 {
 	//Push current options before launching so an early script error resolves correctly.
 	SendControl(FString::Printf(TEXT("npmAutoResolve %d"), NodeJsProcessParams.bAutoResolveNpmDependencies ? 1 : 0));
+	SendControl(FString::Printf(TEXT("frameLanes %d %d"), NodeJsProcessParams.BulkFrameThreshold, NodeJsProcessParams.FrameFragmentSize));
+	SendControl(FString::Printf(TEXT("streamWindow %d"), NodeJsProcessParams.StreamWindowBytes));
+	for (const TPair<FString, int32>& Delta : NodeJsProcessParams.DeltaEvents)
+	{
+		SendControl(FString::Printf(TEXT("delta %s %d"), *Delta.Key, Delta.Value));
+	}
 
 	FString LaunchMethod = TEXT("launchInline");
 	if (!ScriptParams.bInlineLaunchScript)
@@ -20,109 +28,849 @@ bool UNodeComponent::StartScript(const FNodeJsScriptParams& ScriptParams)
 
 	SendControl(FString::Printf(TEXT("%s %s %s"), *LaunchMethod, *ScriptParams.Script, *ScriptParams.ScriptPathRoot));
 
-	//Delay watching by a frame so the launch lands first
-	if (ScriptParams.bWatchFileForChanges)
+	//Delay watching by a frame so the launch lands first
+	if (ScriptParams.bWatchFileForChanges)
+	{
+		const FNodeJsScriptParams Captured = ScriptParams;
+		AsyncTask(ENamedThreads::GameThread, [this, Captured]
+		{
+			SendControl(FString::Printf(TEXT("watch %s %s"), *Captured.Script, *Captured.ScriptPathRoot));
+		});
+	}
+	return true;
+}
+
+bool UNodeComponent::StopScript(const FNodeJsScriptParams& ScriptParams)
+{
+	SendControl(FString::Printf(TEXT("stop %s"), *ScriptParams.Script));
+	return true;
+}
+
+//~ Event emit -------------------------------------------------------------
+
+//Parse a caller-provided JSON value; anything that isn't valid JSON is passed as a raw string. Empty = none.
+static TSharedPtr<FJsonValue> ParseJsonArgument(const FString& JsonArgs)
+{
+	TSharedPtr<FJsonValue> ArgValue;
+	if (!JsonArgs.IsEmpty())
+	{
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonArgs);
+		if (!FJsonSerializer::Deserialize(Reader, ArgValue) || !ArgValue.IsValid())
+		{
+			ArgValue = MakeShared<FJsonValueString>(JsonArgs);
+		}
+	}
+	return ArgValue;
+}
+
+void UNodeComponent::EmitEvent(const FString& EventName, const FString& JsonArgs, const FString& ScriptName)
+{
+	SendEventFrame(EventName, JsonArgs, TArray<TArray<uint8>>(), ScriptName);
+}
+
+void UNodeComponent::EmitEventWithBinary(const FString& EventName, const FString& JsonArgs, const TArray<uint8>& Binary, const FString& ScriptName)
+{
+	TArray<TArray<uint8>> Buffers;
+	Buffers.Add(Binary);
+	SendEventFrame(EventName, JsonArgs, Buffers, ScriptName);
+}
+
+void UNodeComponent::MulticastEvent(const FString& EventName, const FString& JsonArgs, const TArray<FString>& Scripts)
+{
+	SendEventFrame(EventName, JsonArgs, TArray<TArray<uint8>>(), FString(), &Scripts);
+}
+
+void UNodeComponent::MulticastEventWithBinary(const FString& EventName, const FString& JsonArgs, const TArray<uint8>& Binary, const TArray<FString>& Scripts)
+{
+	TArray<TArray<uint8>> Buffers;
+	Buffers.Add(Binary);
+	SendEventFrame(EventName, JsonArgs, Buffers, FString(), &Scripts);
+}
+
+void UNodeComponent::EmitEvent(const FString& EventName, const TSharedRef<FJsonObject>& JsonArg, const FString& ScriptName)
+{
+	FString Serialized;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Serialized);
+	FJsonSerializer::Serialize(JsonArg, Writer);
+	EmitEvent(EventName, Serialized, ScriptName);
+}
+
+void UNodeComponent::SendEventFrame(const FString& EventName, const FString& JsonArgs, const TArray<TArray<uint8>>& Buffers, const FString& ScriptName, const TArray<FString>* MulticastScripts)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(NodeJs_SendEventFrame);
+
+	FString TargetScript = ScriptName.IsEmpty() ? DefaultScriptParams.Script : ScriptName;
+	if (MulticastScripts)
+	{
+		TargetScript = MulticastScripts->Num() > 0 ? FString::Join(*MulticastScripts, TEXT(",")) : TEXT("*");
+	}
+
+	const uint64 TraceId = EventTracer.IsEnabled() ? EventTracer.NewTraceId() : 0;
+	if (TraceId)
+	{
+		EventTracer.AddHop(TraceId, TEXT("SendEventFrame"), FNodeEventTracer::NowMicros(), false, EventName, TargetScript);
+	}
+
+	//Parse the caller-provided JSON value (the single event argument).
+	TSharedPtr<FJsonValue> ArgValue = ParseJsonArgument(JsonArgs);
+
+	TArray<TSharedPtr<FJsonValue>> Args;
+	if (ArgValue.IsValid())
+	{
+		Args.Add(ArgValue);
+	}
+
+	//Append a placeholder per binary buffer; the node bridge swaps them for Buffers.
+	for (int32 i = 0; i < Buffers.Num(); ++i)
+	{
+		TSharedRef<FJsonObject> Placeholder = MakeShared<FJsonObject>();
+		Placeholder->SetNumberField(TEXT("_bin"), i);
+		Args.Add(MakeShared<FJsonValueObject>(Placeholder));
+	}
+
+	TSharedRef<FJsonObject> HeaderObj = MakeShared<FJsonObject>();
+	if (MulticastScripts)
+	{
+		TArray<TSharedPtr<FJsonValue>> Targets;
+		for (const FString& Script : *MulticastScripts)
+		{
+			Targets.Add(MakeShared<FJsonValueString>(Script));
+		}
+		HeaderObj->SetArrayField(TEXT("scripts"), Targets);
+	}
+	else
+	{
+		HeaderObj->SetStringField(TEXT("script"), TargetScript);
+	}
+	HeaderObj->SetStringField(TEXT("name"), EventName);
+	HeaderObj->SetArrayField(TEXT("args"), Args);
+
+	if (TraceId)
+	{
+		TSharedRef<FJsonObject> TraceObj = MakeShared<FJsonObject>();
+		TraceObj->SetNumberField(TEXT("id"), (double)TraceId);
+		HeaderObj->SetObjectField(TEXT("trace"), TraceObj);
+	}
+
+	FString HeaderJson;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&HeaderJson);
+	FJsonSerializer::Serialize(HeaderObj, Writer);
+
+	const TArray<uint8> BinaryTable = FNodeFrameCodec::BuildBinaryTable(Buffers);
+	TArray<uint8> Frame = FNodeFrameCodec::Encode(ENodeFrameType::Event, HeaderJson, BinaryTable);
+
+	QueueFrame(MoveTemp(Frame), ENodeFrameLane::Event, TraceId);
+}
+
+void UNodeComponent::SendControl(const FString& CommandLine)
+{
+	QueueFrame(FNodeFrameCodec::Encode(ENodeFrameType::Control, CommandLine), ENodeFrameLane::Control);
+}
+
+void UNodeComponent::QueueFrame(TArray<uint8>&& Frame, ENodeFrameLane::Type Lane, uint64 TraceId)
+{
+	//Replayed frames go through the live HandleFrame, whose replies (stream acks, keyframe requests,
+	//controls sent from action handlers) have no process to go to and mustn't lazily start one
+	if (bReplaying)
+	{
+		return;
+	}
+
+	if (bLazyAutoStartProcess && !bProcessIsRunning)
+	{
+		StartProcess();
+	}
+
+	if (bOutboundClosed)
+	{
+		return;
+	}
+
+	OutboundLanes.Enqueue(MoveTemp(Frame), Lane, TraceId);
+	if (TraceId)
+	{
+		EventTracer.AddHop(TraceId, TEXT("queued"), FNodeEventTracer::NowMicros(), false);
+	}
+
+	//Whoever flips the flag owns the pipe until the lanes are drained.
+	if (!bOutboundPumpActive.exchange(true))
+	{
+		PumpOutbound(false);
+	}
+}
+
+void UNodeComponent::PumpOutbound(bool bOnBackgroundThread)
+{
+	TArray<uint8> Bytes;
+	uint64 WrittenTraceId = 0;
+	while (true)
+	{
+		//Torn down: stop writing and leave the flag claimed so nothing restarts the pump
+		if (bOutboundClosed)
+		{
+			return;
+		}
+
+		if (OutboundLanes.PopNext(Bytes, bOnBackgroundThread, &WrittenTraceId))
+		{
+			if (ProcessHandler.IsValid())
+			{
+				StreamRecorder.Record(ENodeStreamDirection::ToNode, Bytes.GetData(), Bytes.Num());
+				ProcessHandler->SendInput(Bytes);
+			}
+			if (WrittenTraceId)
+			{
+				EventTracer.AddHop(WrittenTraceId, TEXT("write"), FNodeEventTracer::NowMicros(), false);
+			}
+			continue;
+		}
+
+		//Only bulk left and we're on the caller's thread: keep ownership and move off-thread.
+		//The task is counted from here until it returns; teardown waits for the count to drop to zero.
+		if (!bOnBackgroundThread && OutboundLanes.HasPending())
+		{
+			BeginBackgroundTask();
+			AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this]
+			{
+				PumpOutbound(true);
+				EndBackgroundTask();
+			});
+			return;
+		}
+
+		bOutboundPumpActive = false;
+
+		//Re-claim if something was queued between the last pop and releasing the flag.
+		if (!OutboundLanes.HasPending() || bOutboundPumpActive.exchange(true))
+		{
+			return;
+		}
+	}
+}
+
+//~ Streams --------------------------------------------------------------
+
+int32 UNodeComponent::OpenStream(const FString& StreamName, int64 ExpectedSize, const FString& ScriptName)
+{
+	//Start before registering the stream; starting aborts every stream left from a previous process
+	if (bLazyAutoStartProcess && !bProcessIsRunning && !bReplaying)
+	{
+		StartProcess();
+	}
+
+	int32 StreamId = 0;
+	{
+		FScopeLock ScopeLock(&StreamLock);
+		StreamId = NextStreamId++;
+		OutboundStreams.Add(StreamId);
+	}
+
+	TSharedRef<FJsonObject> HeaderObj = MakeShared<FJsonObject>();
+	HeaderObj->SetStringField(TEXT("op"), TEXT("open"));
+	HeaderObj->SetNumberField(TEXT("id"), StreamId);
+	HeaderObj->SetStringField(TEXT("script"), ScriptName.IsEmpty() ? DefaultScriptParams.Script : ScriptName);
+	HeaderObj->SetStringField(TEXT("name"), StreamName);
+	HeaderObj->SetNumberField(TEXT("size"), (double)ExpectedSize);
+	SendStreamFrame(HeaderObj, TArray<uint8>());
+
+	return StreamId;
+}
+
+bool UNodeComponent::WriteStream(int32 StreamId, const TArray<uint8>& Chunk)
+{
+	{
+		FScopeLock ScopeLock(&StreamLock);
+		FOutboundStream* Stream = OutboundStreams.Find(StreamId);
+		if (!Stream)
+		{
+			return false;
+		}
+
+		//Always let a chunk through on an idle stream so oversized chunks can't deadlock.
+		if (Stream->InFlight > 0 && Stream->InFlight + Chunk.Num() > NodeJsProcessParams.StreamWindowBytes)
+		{
+			return false;
+		}
+		Stream->InFlight += Chunk.Num();
+		Stream->Sent += Chunk.Num();
+	}
+
+	TSharedRef<FJsonObject> HeaderObj = MakeShared<FJsonObject>();
+	HeaderObj->SetStringField(TEXT("op"), TEXT("data"));
+	HeaderObj->SetNumberField(TEXT("id"), StreamId);
+	SendStreamFrame(HeaderObj, Chunk);
+	return true;
+}
+
+int64 UNodeComponent::GetStreamWritableBytes(int32 StreamId)
+{
+	FScopeLock ScopeLock(&StreamLock);
+	const FOutboundStream* Stream = OutboundStreams.Find(StreamId);
+	return Stream ? FMath::Max<int64>(0, NodeJsProcessParams.StreamWindowBytes - Stream->InFlight) : 0;
+}
+
+void UNodeComponent::EndStream(int32 StreamId)
+{
+	FOutboundStream Stream;
+	{
+		FScopeLock ScopeLock(&StreamLock);
+		if (!OutboundStreams.RemoveAndCopyValue(StreamId, Stream))
+		{
+			return;
+		}
+	}
+
+	TSharedRef<FJsonObject> HeaderObj = MakeShared<FJsonObject>();
+	HeaderObj->SetStringField(TEXT("op"), TEXT("end"));
+	HeaderObj->SetNumberField(TEXT("id"), StreamId);
+	HeaderObj->SetNumberField(TEXT("total"), (double)Stream.Sent);
+	SendStreamFrame(HeaderObj, TArray<uint8>());
+}
+
+void UNodeComponent::AbortStream(int32 StreamId, const FString& Reason)
+{
+	{
+		FScopeLock ScopeLock(&StreamLock);
+		if (OutboundStreams.Remove(StreamId) == 0)
+		{
+			return;
+		}
+	}
+
+	TSharedRef<FJsonObject> HeaderObj = MakeShared<FJsonObject>();
+	HeaderObj->SetStringField(TEXT("op"), TEXT("abort"));
+	HeaderObj->SetNumberField(TEXT("id"), StreamId);
+	HeaderObj->SetStringField(TEXT("reason"), Reason);
+	SendStreamFrame(HeaderObj, TArray<uint8>());
+}
+
+void UNodeComponent::SendStreamFrame(const TSharedRef<FJsonObject>& HeaderObj, const TArray<uint8>& Chunk)
+{
+	FString HeaderJson;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&HeaderJson);
+	FJsonSerializer::Serialize(HeaderObj, Writer);
+
+	//Acks carry no ordering; everything else must stay in sequence, so it rides the bulk lane.
+	const bool bIsAck = HeaderObj->GetStringField(TEXT("op")) == TEXT("ack");
+	QueueFrame(FNodeFrameCodec::Encode(ENodeFrameType::Stream, HeaderJson, Chunk), bIsAck ? ENodeFrameLane::Control : ENodeFrameLane::Bulk);
+}
+
+void UNodeComponent::HandleStreamFrame(const FString& Header, const TArray<uint8>& Binary)
+{
+	TSharedPtr<FJsonObject> Obj;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Header);
+	if (!FJsonSerializer::Deserialize(Reader, Obj) || !Obj.IsValid())
+	{
+		UE_LOG(LogNodeJs, Warning, TEXT("Bad stream header '%s'"), *Header);
+		return;
+	}
+
+	const FString Op = Obj->GetStringField(TEXT("op"));
+	const int32 StreamId = (int32)Obj->GetNumberField(TEXT("id"));
+
+	if (Op == TEXT("data"))
+	{
+		FInboundStream* Stream = InboundStreams.Find(StreamId);
+		if (!Stream)
+		{
+			return;
+		}
+		Stream->Received += Binary.Num();
+		OnStreamChunkNative.Broadcast(StreamId, Stream->Name, TArrayView<const uint8>(Binary.GetData(), Binary.Num()));
+
+		//Handler returned; the chunk is consumed, give the sender its credit back.
+		TSharedRef<FJsonObject> AckObj = MakeShared<FJsonObject>();
+		AckObj->SetStringField(TEXT("op"), TEXT("ack"));
+		AckObj->SetNumberField(TEXT("id"), StreamId);
+		AckObj->SetNumberField(TEXT("bytes"), Binary.Num());
+		SendStreamFrame(AckObj, TArray<uint8>());
+	}
+	else if (Op == TEXT("open"))
+	{
+		FInboundStream& Stream = InboundStreams.Add(StreamId);
+		Stream.Name = Obj->GetStringField(TEXT("name"));
+		OnStreamOpenNative.Broadcast(StreamId, Stream.Name, Obj->GetStringField(TEXT("script")), (int64)Obj->GetNumberField(TEXT("size")));
+	}
+	else if (Op == TEXT("end") || Op == TEXT("abort"))
+	{
+		FInboundStream Stream;
+		if (InboundStreams.RemoveAndCopyValue(StreamId, Stream))
+		{
+			OnStreamEndNative.Broadcast(StreamId, Stream.Name, Stream.Received, Op == TEXT("abort"));
+		}
+	}
+	else if (Op == TEXT("reject"))
+	{
+		//node refused one of our streams (e.g. no inline target).
+		{
+			FScopeLock ScopeLock(&StreamLock);
+			if (OutboundStreams.Remove(StreamId) == 0)
+			{
+				return;
+			}
+		}
+		const FString Reason = Obj->GetStringField(TEXT("reason"));
+		UE_LOG(LogNodeJs, Warning, TEXT("Stream %d rejected by node: %s"), StreamId, *Reason);
+		OnStreamClosedNative.Broadcast(StreamId, Reason);
+	}
+	else if (Op == TEXT("ack"))
+	{
+		int64 Writable = 0;
+		{
+			FScopeLock ScopeLock(&StreamLock);
+			FOutboundStream* Stream = OutboundStreams.Find(StreamId);
+			if (!Stream)
+			{
+				return;
+			}
+			Stream->InFlight = FMath::Max<int64>(0, Stream->InFlight - (int64)Obj->GetNumberField(TEXT("bytes")));
+			Writable = FMath::Max<int64>(0, NodeJsProcessParams.StreamWindowBytes - Stream->InFlight);
+		}
+		OnStreamWritableNative.Broadcast(StreamId, Writable);
+	}
+}
+
+void UNodeComponent::AbortOpenStreams(const FString& Reason)
+{
+	TMap<int32, FOutboundStream> Outbound;
+	{
+		FScopeLock ScopeLock(&StreamLock);
+		Outbound = MoveTemp(OutboundStreams);
+		OutboundStreams.Reset();
+	}
+	TMap<int32, FInboundStream> Inbound = MoveTemp(InboundStreams);
+	InboundStreams.Reset();
+
+	for (const TPair<int32, FOutboundStream>& Pair : Outbound)
+	{
+		OnStreamClosedNative.Broadcast(Pair.Key, Reason);
+	}
+	for (const TPair<int32, FInboundStream>& Pair : Inbound)
+	{
+		OnStreamEndNative.Broadcast(Pair.Key, Pair.Value.Name, Pair.Value.Received, true);
+	}
+}
+
+//~ Lockstep -------------------------------------------------------------
+
+void UNodeComponent::SetLockstepEnabled(bool bEnabled)
+{
+	NodeJsProcessParams.bLockstep = bEnabled;
+	SetComponentTickEnabled(bEnabled);
+}
+
+void UNodeComponent::AddLockstepInput(const FString& JsonInput)
+{
+	TSharedPtr<FJsonValue> Input = ParseJsonArgument(JsonInput);
+	if (!Input.IsValid())
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&LockstepLock);
+	PendingLockstepInputs.Add(Input);
+}
+
+void UNodeComponent::AddLockstepInputWithBinary(const FString& JsonInput, const TArray<uint8>& Binary)
+{
+	TSharedPtr<FJsonValue> Input = ParseJsonArgument(JsonInput);
+
+	FScopeLock ScopeLock(&LockstepLock);
+	if (Input.IsValid())
+	{
+		PendingLockstepInputs.Add(Input);
+	}
+
+	TSharedRef<FJsonObject> Placeholder = MakeShared<FJsonObject>();
+	Placeholder->SetNumberField(TEXT("_bin"), PendingLockstepBuffers.Num());
+	PendingLockstepInputs.Add(MakeShared<FJsonValueObject>(Placeholder));
+	PendingLockstepBuffers.Add(Binary);
+}
+
+void UNodeComponent::RunLockstepTick(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(NodeJs_LockstepTick);
+
+	const int64 Frame = ++LockstepFrame;
+
+	TArray<TSharedPtr<FJsonValue>> Inputs;
+	TArray<TArray<uint8>> Buffers;
+	{
+		FScopeLock ScopeLock(&LockstepLock);
+		Inputs = MoveTemp(PendingLockstepInputs);
+		Buffers = MoveTemp(PendingLockstepBuffers);
+		AwaitedLockstepFrame = Frame;
+	}
+	LockstepSignal->Reset();
+
+	TSharedRef<FJsonObject> HeaderObj = MakeShared<FJsonObject>();
+	HeaderObj->SetStringField(TEXT("script"), NodeJsProcessParams.LockstepScript.IsEmpty() ? DefaultScriptParams.Script : NodeJsProcessParams.LockstepScript);
+	HeaderObj->SetNumberField(TEXT("frame"), (double)Frame);
+	HeaderObj->SetNumberField(TEXT("dt"), DeltaTime);
+	HeaderObj->SetStringField(TEXT("name"), NodeJsProcessParams.LockstepTickEvent);
+	HeaderObj->SetStringField(TEXT("reply"), NodeJsProcessParams.LockstepResultEvent);
+	HeaderObj->SetArrayField(TEXT("inputs"), Inputs);
+
+	FString HeaderJson;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&HeaderJson);
+	FJsonSerializer::Serialize(HeaderObj, Writer);
+
+	//Control lane: nothing queued ahead of it, written before we start waiting
+	QueueFrame(FNodeFrameCodec::Encode(ENodeFrameType::Tick, HeaderJson, FNodeFrameCodec::BuildBinaryTable(Buffers)), ENodeFrameLane::Control);
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(NodeJs_LockstepWait);
+		LockstepSignal->Wait(FTimespan::FromMicroseconds(FMath::Max(0, NodeJsProcessParams.LockstepBudgetMicros)));
+	}
+
+	//The reader thread only stores results for the awaited frame, so anything else is the previous one.
+	int64 ResultFrame;
+	FString ResultJson;
+	TArray<TArray<uint8>> ResultBuffers;
+	{
+		FScopeLock ScopeLock(&LockstepLock);
+		AwaitedLockstepFrame = 0;
+		ResultFrame = LockstepResultFrame;
+		ResultJson = LockstepResultJson;
+		ResultBuffers = LockstepResultBuffers;
+	}
+
+	const bool bIsStale = ResultFrame != Frame;
+	if (bIsStale)
+	{
+		LockstepMissedDeadlines++;
+		if (!NodeJsProcessParams.bLockstepReusePreviousResult || ResultFrame == 0)
+		{
+			return;
+		}
+	}
+
+	static const TArray<uint8> NoBuffer;
+	OnLockstepResult.Broadcast(ResultFrame, ResultJson, ResultBuffers.Num() > 0 ? ResultBuffers[0] : NoBuffer, bIsStale);
+	OnLockstepResultNative.Broadcast(ResultFrame, ResultJson, ResultBuffers, bIsStale);
+}
+
+void UNodeComponent::HandleTickResult(const FString& Header, const TArray<uint8>& Binary)
+{
+	//{ script, frame, args:[...] }
+	TSharedPtr<FJsonObject> Obj;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Header);
+	if (!FJsonSerializer::Deserialize(Reader, Obj) || !Obj.IsValid())
+	{
+		return;
+	}
+
+	//Frames start at 1; 0 means no tick is waiting, so a result without a frame never matches
+	double FrameNumber = 0;
+	if (!Obj->TryGetNumberField(TEXT("frame"), FrameNumber) || (int64)FrameNumber == 0)
+	{
+		UE_LOG(LogNodeJs, Warning, TEXT("Lockstep result without a frame dropped"));
+		return;
+	}
+	const int64 Frame = (int64)FrameNumber;
+	{
+		FScopeLock ScopeLock(&LockstepLock);
+		if (Frame != AwaitedLockstepFrame)
+		{
+			UE_LOG(LogNodeJs, Verbose, TEXT("Late lockstep result for frame %lld dropped"), Frame);
+			return;
+		}
+	}
+
+	//A single result arg is surfaced as-is, several as an array
+	FString ResultJson;
+	const TArray<TSharedPtr<FJsonValue>>* Args = nullptr;
+	if (Obj->TryGetArrayField(TEXT("args"), Args) && Args->Num() > 0)
+	{
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResultJson);
+		if (Args->Num() == 1)
+		{
+			FJsonSerializer::Serialize((*Args)[0], TEXT(""), Writer);
+		}
+		else
+		{
+			FJsonSerializer::Serialize(*Args, Writer);
+		}
+	}
+
+	TArray<TArray<uint8>> Buffers;
+	FNodeFrameCodec::ParseBinaryTable(Binary, Buffers);
+
+	FScopeLock ScopeLock(&LockstepLock);
+	if (AwaitedLockstepFrame != 0 && Frame == AwaitedLockstepFrame && LockstepSignal)
+	{
+		LockstepResultFrame = Frame;
+		LockstepResultJson = MoveTemp(ResultJson);
+		LockstepResultBuffers = MoveTemp(Buffers);
+		LockstepSignal->Trigger();
+	}
+}
+
+//~ Delta events ---------------------------------------------------------
+
+void UNodeComponent::SetEventDelta(const FString& EventName, int32 KeyframeInterval)
+{
+	if (KeyframeInterval > 0)
+	{
+		NodeJsProcessParams.DeltaEvents.Add(EventName, KeyframeInterval);
+	}
+	else
+	{
+		NodeJsProcessParams.DeltaEvents.Remove(EventName);
+	}
+	SendControl(FString::Printf(TEXT("delta %s %d"), *EventName, FMath::Max(0, KeyframeInterval)));
+}
+
+void UNodeComponent::RequestKeyframe(const FString& EventName, const FString& ScriptName)
+{
+	const FString TargetScript = ScriptName.IsEmpty() ? DefaultScriptParams.Script : ScriptName;
+	SendControl(FString::Printf(TEXT("keyframe %s %s"), *TargetScript, *EventName));
+}
+
+//~ Subprocess pool ------------------------------------------------------
+
+void UNodeComponent::SetSubprocessPoolSize(int32 PoolSize)
+{
+	NodeJsProcessParams.SubprocessPoolSize = FMath::Max(0, PoolSize);
+	SendControl(FString::Printf(TEXT("childPool %d"), NodeJsProcessParams.SubprocessPoolSize));
+}
+
+//~ Profiling ------------------------------------------------------------
+
+void UNodeComponent::StartCpuProfile(const FString& ScriptName)
+{
+	SendControl(FString::Printf(TEXT("profile start %s"), *ScriptName));
+}
+
+void UNodeComponent::StopCpuProfile(const FString& ScriptName)
+{
+	SendControl(FString::Printf(TEXT("profile stop %s"), *ScriptName));
+}
+
+void UNodeComponent::WriteHeapSnapshot(const FString& ScriptName)
+{
+	SendControl(FString::Printf(TEXT("heapsnapshot %s"), *ScriptName));
+}
+
+void UNodeComponent::SetRuntimeStatsInterval(int32 IntervalMs)
+{
+	NodeJsProcessParams.RuntimeStatsIntervalMs = IntervalMs;
+	SendControl(FString::Printf(TEXT("stats %d"), IntervalMs));
+}
+
+//~ Event tracing --------------------------------------------------------
+
+void UNodeComponent::StartEventTrace()
+{
+	EventTracer.Reset();
+	EventTracer.Start();
+	SendControl(TEXT("trace 1"));
+}
+
+FString UNodeComponent::StopEventTrace(const FString& Filename)
+{
+	if (bProcessIsRunning)
+	{
+		SendControl(TEXT("trace 0"));
+	}
+	EventTracer.Stop();
+
+	FString Target = Filename;
+	if (Target.IsEmpty())
+	{
+		Target = FString::Printf(TEXT("%s-%s.json"), *GetNameSafe(GetOwner()), *FDateTime::Now().ToString());
+	}
+	if (FPaths::IsRelative(Target))
+	{
+		Target = FPaths::ProjectSavedDir() / TEXT("Profiling/NodeJs") / Target;
+	}
+
+	if (!EventTracer.WriteChromeTrace(Target))
 	{
-		const FNodeJsScriptParams Captured = ScriptParams;
-		AsyncTask(ENamedThreads::GameThread, [this, Captured]
-		{
-			SendControl(FString::Printf(TEXT("watch %s %s"), *Captured.Script, *Captured.ScriptPathRoot));
-		});
+		return FString();
 	}
-	return true;
+	UE_LOG(LogNodeJs, Log, TEXT("Wrote event trace to %s"), *Target);
+	return Target;
 }
 
-bool UNodeComponent::StopScript(const FNodeJsScriptParams& ScriptParams)
+void UNodeComponent::TraceDispatch(uint64 TraceId, const TCHAR* Stage)
 {
-	SendControl(FString::Printf(TEXT("stop %s"), *ScriptParams.Script));
-	return true;
+	if (TraceId)
+	{
+		EventTracer.AddHop(TraceId, Stage, FNodeEventTracer::NowMicros(), false);
+	}
 }
 
-//~ Event emit -------------------------------------------------------------
+//~ Stream recording -----------------------------------------------------
 
-void UNodeComponent::EmitEvent(const FString& EventName, const FString& JsonArgs, const FString& ScriptName)
+bool UNodeComponent::StartStreamRecording(const FString& Filename)
 {
-	SendEventFrame(EventName, JsonArgs, TArray<TArray<uint8>>(), ScriptName);
-}
+	const FString RecordingDir = FPaths::ProjectSavedDir() / TEXT("NodeJs/Recordings");
 
-void UNodeComponent::EmitEventWithBinary(const FString& EventName, const FString& JsonArgs, const TArray<uint8>& Binary, const FString& ScriptName)
-{
-	TArray<TArray<uint8>> Buffers;
-	Buffers.Add(Binary);
-	SendEventFrame(EventName, JsonArgs, Buffers, ScriptName);
+	FString Target = Filename;
+	if (Target.IsEmpty())
+	{
+		Target = FString::Printf(TEXT("%s-%s.nuerec"), *GetNameSafe(GetOwner()), *FDateTime::Now().ToString());
+	}
+	if (FPaths::IsRelative(Target))
+	{
+		Target = RecordingDir / Target;
+	}
+
+	if (!StreamRecorder.Open(Target))
+	{
+		return false;
+	}
+	UE_LOG(LogNodeJs, Log, TEXT("Recording frame stream to %s"), *Target);
+	return true;
 }
 
-void UNodeComponent::EmitEvent(const FString& EventName, const TSharedRef<FJsonObject>& JsonArg, const FString& ScriptName)
+void UNodeComponent::StopStreamRecording()
 {
-	FString Serialized;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Serialized);
-	FJsonSerializer::Serialize(JsonArg, Writer);
-	EmitEvent(EventName, Serialized, ScriptName);
+	StreamRecorder.Close();
 }
 
-void UNodeComponent::SendEventFrame(const FString& EventName, const FString& JsonArgs, const TArray<TArray<uint8>>& Buffers, const FString& ScriptName)
+void UNodeComponent::ReplayStreamRecording(const FString& Filename, bool bRealtime)
 {
-	const FString TargetScript = ScriptName.IsEmpty() ? DefaultScriptParams.Script : ScriptName;
+	const FString Target = FPaths::IsRelative(Filename) ? FPaths::ProjectSavedDir() / TEXT("NodeJs/Recordings") / Filename : Filename;
 
-	//Parse the caller-provided JSON value (the single event argument).
-	TSharedPtr<FJsonValue> ArgValue;
-	if (!JsonArgs.IsEmpty())
+	//HandleFrame state is reader-thread only; the replay thread takes the reader's place.
+	if (bProcessIsRunning)
 	{
-		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonArgs);
-		if (!FJsonSerializer::Deserialize(Reader, ArgValue) || !ArgValue.IsValid())
-		{
-			//Fall back to treating it as a raw string argument.
-			ArgValue = MakeShared<FJsonValueString>(JsonArgs);
-		}
+		UE_LOG(LogNodeJs, Warning, TEXT("Not replaying %s: the node process is running"), *Target);
+		return;
 	}
-
-	TArray<TSharedPtr<FJsonValue>> Args;
-	if (ArgValue.IsValid())
+	if (bReplaying.exchange(true))
 	{
-		Args.Add(ArgValue);
+		UE_LOG(LogNodeJs, Warning, TEXT("Not replaying %s: a replay is already running"), *Target);
+		return;
 	}
-
-	//Append a placeholder per binary buffer; the node bridge swaps them for Buffers.
-	for (int32 i = 0; i < Buffers.Num(); ++i)
+	if (ReplayTask.IsValid())
 	{
-		TSharedRef<FJsonObject> Placeholder = MakeShared<FJsonObject>();
-		Placeholder->SetNumberField(TEXT("_bin"), i);
-		Args.Add(MakeShared<FJsonValueObject>(Placeholder));
+		ReplayTask.Wait();
 	}
+	bCancelReplay = false;
 
-	TSharedRef<FJsonObject> HeaderObj = MakeShared<FJsonObject>();
-	HeaderObj->SetStringField(TEXT("script"), TargetScript);
-	HeaderObj->SetStringField(TEXT("name"), EventName);
-	HeaderObj->SetArrayField(TEXT("args"), Args);
+	ReplayTask = Async(EAsyncExecution::Thread, [this, Target, bRealtime]
+	{
+		ON_SCOPE_EXIT
+		{
+			bReplaying = false;
+		};
 
-	FString HeaderJson;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&HeaderJson);
-	FJsonSerializer::Serialize(HeaderObj, Writer);
+		FNodeStreamReplayer Replayer;
+		if (!Replayer.Open(Target))
+		{
+			return;
+		}
 
-	const TArray<uint8> BinaryTable = FNodeFrameCodec::BuildBinaryTable(Buffers);
-	const TArray<uint8> Frame = FNodeFrameCodec::Encode(ENodeFrameType::Event, HeaderJson, BinaryTable);
+		//Private codec so a live process can keep using Decoder meanwhile.
+		FNodeFrameCodec ReplayDecoder;
+		int32 Frames = 0;
+		ReplayDecoder.OnFrame = [this, &Frames](uint8 Type, const FString& Header, const TArray<uint8>& Binary)
+		{
+			++Frames;
+			HandleFrame(Type, Header, Binary);
+		};
 
-	if (bLazyAutoStartProcess && !bProcessIsRunning)
+		int64 Bytes = 0;
+		const double StartSeconds = FPlatformTime::Seconds();
+		const int32 Records = Replayer.Replay(ENodeStreamDirection::FromNode, bRealtime, [&ReplayDecoder, &Bytes](const uint8* Data, int32 Num)
+		{
+			Bytes += Num;
+			ReplayDecoder.Feed(Data, Num);
+		}, &bCancelReplay);
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+		UE_LOG(LogNodeJs, Log, TEXT("Replayed %s: %d records, %d frames, %lld bytes in %.2f ms"), *Target, Records, Frames, Bytes, ElapsedMs);
+	});
+}
+
+//~ Event dispatch policy ------------------------------------------------
+
+void UNodeComponent::SetEventDispatchPolicy(const FString& EventName, ENodeEventDispatch Policy)
+{
+	EventDispatchPolicies.Add(EventName, Policy);
+
+	FScopeLock ScopeLock(&DispatchPolicyLock);
+	ActiveDispatchPolicies.Add(EventName, Policy);
+}
+
+ENodeEventDispatch UNodeComponent::GetEventDispatchPolicy(const FString& EventName)
+{
+	FScopeLock ScopeLock(&DispatchPolicyLock);
+	const ENodeEventDispatch* Policy = ActiveDispatchPolicies.Find(EventName);
+	return Policy ? *Policy : ENodeEventDispatch::GameThread;
+}
+
+void UNodeComponent::QueueBackgroundDispatch(const FString& EventName, FBackgroundDispatch&& Dispatch)
+{
+	FScopeLock ScopeLock(&BackgroundDispatchLock);
+
+	//Torn down (set before teardown empties the queues under this lock)
+	if (bOutboundClosed)
 	{
-		StartProcess();
+		return;
 	}
-	if (ProcessHandler.IsValid())
+
+	//A queue only exists while a task is draining it; otherwise start one
+	FBackgroundDispatchQueue* Queue = BackgroundDispatchQueues.Find(EventName);
+	if (Queue)
 	{
-		ProcessHandler->SendInput(Frame);
+		Queue->Pending.Add(MoveTemp(Dispatch));
+		return;
 	}
+	BackgroundDispatchQueues.Add(EventName).Pending.Add(MoveTemp(Dispatch));
+
+	//Counted until the task returns; teardown waits for the count to drop to zero
+	BeginBackgroundTask();
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this, EventName]
+	{
+		DrainBackgroundDispatch(EventName);
+		EndBackgroundTask();
+	});
 }
 
-void UNodeComponent::SendControl(const FString& CommandLine)
+void UNodeComponent::DrainBackgroundDispatch(const FString& EventName)
 {
-	const TArray<uint8> Frame = FNodeFrameCodec::Encode(ENodeFrameType::Control, CommandLine);
-
-	if (bLazyAutoStartProcess && !bProcessIsRunning)
+	while (true)
 	{
-		StartProcess();
+		FBackgroundDispatch Dispatch;
+		{
+			FScopeLock ScopeLock(&BackgroundDispatchLock);
+			FBackgroundDispatchQueue* Queue = BackgroundDispatchQueues.Find(EventName);
+			if (!Queue)
+			{
+				//Cleared on teardown
+				return;
+			}
+			if (Queue->Pending.Num() == 0)
+			{
+				BackgroundDispatchQueues.Remove(EventName);
+				return;
+			}
+			Dispatch = MoveTemp(Queue->Pending[0]);
+			Queue->Pending.RemoveAt(0, 1, EAllowShrinking::No);
+		}
+
+		TraceDispatch(Dispatch.TraceId, TEXT("dispatch"));
+		OnEventNative.Broadcast(EventName, Dispatch.ArgsJson, Dispatch.Buffers);
+		TraceDispatch(Dispatch.TraceId, TEXT("handled"));
 	}
-	if (ProcessHandler.IsValid())
+}
+
+void UNodeComponent::BeginBackgroundTask()
+{
+	++BackgroundTasks;
+}
+
+void UNodeComponent::EndBackgroundTask()
+{
+	//Under the lock so teardown can't return the event to the pool between the decrement and the trigger
+	FScopeLock ScopeLock(&BackgroundTasksLock);
+	if (--BackgroundTasks == 0 && BackgroundTasksIdle)
 	{
-		ProcessHandler->SendInput(Frame);
+		BackgroundTasksIdle->Trigger();
 	}
 }
 
@@ -130,13 +878,17 @@ void UNodeComponent::SendControl(const FString& CommandLine)
 
 UNodeComponent::UNodeComponent()
 {
-	PrimaryComponentTick.bCanEverTick = false;
+	//Only lockstep mode ticks
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 
 	SyncCLIParams();
 }
 
 void UNodeComponent::SyncCLIParams()
 {
+	OutboundLanes.SetSizes(FMath::Max(NodeJsProcessParams.BulkFrameThreshold, 1024), FMath::Max(NodeJsProcessParams.FrameFragmentSize, 1024));
+
 	if (!NodeJsProcessParams.bSyncCLIParams)
 	{
 		return;
@@ -170,14 +922,67 @@ void UNodeComponent::SyncCLIParams()
 
 void UNodeComponent::StartProcess()
 {
+	if (bReplaying)
+	{
+		UE_LOG(LogNodeJs, Warning, TEXT("Not starting the node process while a stream recording is replaying"));
+		return;
+	}
+
 	//Ensure these are synced before we start
 	SyncCLIParams();
 
+	//Nothing from a previous process carries over: half-received fragments would be glued onto the
+	//new process's fragments (ids restart at 1), and queued frames were meant for the old one
+	Decoder.Reset();
+	OutboundLanes.Reset();
+	AbortOpenStreams(TEXT("node process restarted"));
+	ClearRuntimeStats();
+
+	if (NodeJsProcessParams.bRecordFrameStream)
+	{
+		StartStreamRecording(NodeJsProcessParams.FrameStreamRecordingFile);
+	}
+
 	Super::StartProcess();
 }
 
+void UNodeComponent::ClearRuntimeStats()
+{
+	if (IsInGameThread())
+	{
+		LatestRuntimeStats.Empty();
+		return;
+	}
+	AsyncTask(ENamedThreads::GameThread, [this] { LatestRuntimeStats.Empty(); });
+}
+
+void UNodeComponent::StopProcess()
+{
+	Super::StopProcess();
+
+	AbortOpenStreams(TEXT("node process stopped"));
+	ClearRuntimeStats();
+}
+
 void UNodeComponent::BeginProcessingExtraHandler(const FString& StartUpState)
 {
+	if (NodeJsProcessParams.bTraceEvents)
+	{
+		StartEventTrace();
+	}
+
+	//Once per process: resending on every launch would restart the samplers
+	if (NodeJsProcessParams.RuntimeStatsIntervalMs > 0)
+	{
+		SendControl(FString::Printf(TEXT("stats %d"), NodeJsProcessParams.RuntimeStatsIntervalMs));
+	}
+
+	//Warm the subprocess pool as early as possible so the first launch can use it
+	if (NodeJsProcessParams.SubprocessPoolSize > 0)
+	{
+		SetSubprocessPoolSize(NodeJsProcessParams.SubprocessPoolSize);
+	}
+
 	if (HasBegunPlay() && NodeJsProcessParams.bStartDefaultScriptOnBeginPlay)
 	{
 		StartScript(DefaultScriptParams);
@@ -188,6 +993,8 @@ void UNodeComponent::BeginProcessingExtraHandler(const FString& StartUpState)
 
 void UNodeComponent::HandleFrame(uint8 Type, const FString& Header, const TArray<uint8>& Binary)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(NodeJs_HandleFrame);
+
 	switch (Type)
 	{
 	case ENodeFrameType::Log:
@@ -238,7 +1045,19 @@ void UNodeComponent::HandleFrame(uint8 Type, const FString& Header, const TArray
 		}
 		else if (Verb == TEXT("end"))
 		{
-			AsyncTask(ENamedThreads::GameThread, [this, ScriptPath] { OnScriptEnd.Broadcast(ScriptPath); });
+			AsyncTask(ENamedThreads::GameThread, [this, ScriptPath]
+			{
+				//A subprocess that ended won't sample again; don't keep reporting its last sample
+				const FString NormalizedPath = ScriptPath.Replace(TEXT("\\"), TEXT("/"));
+				for (auto It = LatestRuntimeStats.CreateIterator(); It; ++It)
+				{
+					if (!It.Key().IsEmpty() && (NormalizedPath == It.Key() || NormalizedPath.EndsWith(TEXT("/") + It.Key())))
+					{
+						It.RemoveCurrent();
+					}
+				}
+				OnScriptEnd.Broadcast(ScriptPath);
+			});
 		}
 		else if (Verb == TEXT("begin"))
 		{
@@ -260,27 +1079,186 @@ void UNodeComponent::HandleFrame(uint8 Type, const FString& Header, const TArray
 		FString EventName;
 		Obj->TryGetStringField(TEXT("name"), EventName);
 
-		//Re-serialize the args array as the delegate payload.
-		FString ArgsJson = TEXT("[]");
-		const TArray<TSharedPtr<FJsonValue>>* ArgsArray = nullptr;
-		if (Obj->TryGetArrayField(TEXT("args"), ArgsArray) && ArgsArray)
+		//Hops node stamped on the way out, plus our decode.
+		uint64 TraceId = 0;
+		const TSharedPtr<FJsonObject>* TraceObj = nullptr;
+		if (EventTracer.IsEnabled() && Obj->TryGetObjectField(TEXT("trace"), TraceObj))
 		{
-			ArgsJson.Reset();
-			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ArgsJson);
-			FJsonSerializer::Serialize(*ArgsArray, Writer);
+			const int64 DecodedMicros = FNodeEventTracer::NowMicros();
+			TraceId = (uint64)(*TraceObj)->GetNumberField(TEXT("id"));
+
+			double ParentId = 0;
+			(*TraceObj)->TryGetNumberField(TEXT("parent"), ParentId);
+
+			FString ScriptName;
+			Obj->TryGetStringField(TEXT("script"), ScriptName);
+
+			const TArray<TSharedPtr<FJsonValue>>* Hops = nullptr;
+			if ((*TraceObj)->TryGetArrayField(TEXT("hops"), Hops))
+			{
+				EventTracer.AddNodeHops(TraceId, *Hops, EventName, ScriptName, (uint64)ParentId);
+			}
+			EventTracer.AddHop(TraceId, TEXT("decode"), DecodedMicros, false, EventName, ScriptName, (uint64)ParentId);
 		}
 
-		//First interweaved buffer (if any) is surfaced directly to Blueprint.
 		TArray<TArray<uint8>> Buffers;
 		FNodeFrameCodec::ParseBinaryTable(Binary, Buffers);
-		const TArray<uint8> FirstBuffer = Buffers.Num() > 0 ? Buffers[0] : TArray<uint8>();
 
-		AsyncTask(ENamedThreads::GameThread, [this, EventName, ArgsJson, FirstBuffer]
+		TArray<TSharedPtr<FJsonValue>> Args;
+		const TArray<TSharedPtr<FJsonValue>>* ArgsArray = nullptr;
+		if (Obj->TryGetArrayField(TEXT("args"), ArgsArray) && ArgsArray)
+		{
+			Args = *ArgsArray;
+		}
+
+		//Delta-mode events only carry what changed; rebuild the full value first.
+		const TSharedPtr<FJsonObject>* DeltaObj = nullptr;
+		if (Obj->TryGetObjectField(TEXT("delta"), DeltaObj))
+		{
+			FString ScriptName;
+			Obj->TryGetStringField(TEXT("script"), ScriptName);
+
+			const FNodeDeltaDecoder::EResult Result = DeltaDecoder.Apply(ScriptName + TEXT("\n") + EventName, **DeltaObj, Args, Buffers);
+			if (Result != FNodeDeltaDecoder::EResult::Applied)
+			{
+				if (Result == FNodeDeltaDecoder::EResult::NeedKeyframe)
+				{
+					UE_LOG(LogNodeJs, Verbose, TEXT("[%s] '%s' delta out of sequence, requesting keyframe"), *ScriptName, *EventName);
+					RequestKeyframe(EventName, ScriptName);
+				}
+				break;
+			}
+		}
+
+		//Re-serialize the args array as the delegate payload.
+		FString ArgsJson;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ArgsJson);
+		FJsonSerializer::Serialize(Args, Writer);
+
+		switch (GetEventDispatchPolicy(EventName))
+		{
+		case ENodeEventDispatch::ReaderThread:
+			TraceDispatch(TraceId, TEXT("dispatch"));
+			OnEventNative.Broadcast(EventName, ArgsJson, Buffers);
+			TraceDispatch(TraceId, TEXT("handled"));
+			break;
+		case ENodeEventDispatch::BackgroundTask:
+			QueueBackgroundDispatch(EventName, { ArgsJson, MoveTemp(Buffers), TraceId });
+			break;
+		default:
+			AsyncTask(ENamedThreads::GameThread, [this, EventName, ArgsJson, Buffers = MoveTemp(Buffers), TraceId]
+			{
+				TRACE_CPUPROFILER_EVENT_SCOPE(NodeJs_BroadcastEvent);
+				TraceDispatch(TraceId, TEXT("dispatch"));
+
+				//First interweaved buffer (if any) is surfaced directly to Blueprint.
+				static const TArray<uint8> NoBuffer;
+				OnEvent.Broadcast(EventName, ArgsJson, Buffers.Num() > 0 ? Buffers[0] : NoBuffer);
+				OnEventNative.Broadcast(EventName, ArgsJson, Buffers);
+
+				TraceDispatch(TraceId, TEXT("handled"));
+			});
+			break;
+		}
+		break;
+	}
+	case ENodeFrameType::Profile:
+	{
+		TSharedPtr<FJsonObject> Obj;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Header);
+		FString ScriptPath, Kind, FilePath, ErrorMessage;
+		if (FJsonSerializer::Deserialize(Reader, Obj) && Obj.IsValid())
+		{
+			Obj->TryGetStringField(TEXT("script"), ScriptPath);
+			Obj->TryGetStringField(TEXT("kind"), Kind);
+			Obj->TryGetStringField(TEXT("path"), FilePath);
+			Obj->TryGetStringField(TEXT("error"), ErrorMessage);
+		}
+
+		if (ErrorMessage.IsEmpty())
+		{
+			UE_LOG(LogNodeJs, Log, TEXT("Wrote %s %s"), *Kind, *FilePath);
+		}
+		else
+		{
+			UE_LOG(LogNodeJs, Warning, TEXT("[%s] %s failed: %s"), *ScriptPath, *Kind, *ErrorMessage);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [this, ScriptPath, Kind, FilePath, ErrorMessage]
+		{
+			OnProfileWritten.Broadcast(ScriptPath, Kind, FilePath, ErrorMessage);
+		});
+		break;
+	}
+	case ENodeFrameType::Stats:
+	{
+		//{ script, eventLoopDelay:{min,max,mean,p50,p99}, cpu:{user,system}, memory:{rss,heapUsed,heapTotal,external} }
+		TSharedPtr<FJsonObject> Obj;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Header);
+		if (!FJsonSerializer::Deserialize(Reader, Obj) || !Obj.IsValid())
+		{
+			break;
+		}
+
+		FNodeRuntimeStats Stats;
+		Obj->TryGetStringField(TEXT("script"), Stats.Script);
+
+		const TSharedPtr<FJsonObject>* Section = nullptr;
+		if (Obj->TryGetObjectField(TEXT("eventLoopDelay"), Section))
+		{
+			Stats.EventLoopDelayMeanMs = (*Section)->GetNumberField(TEXT("mean"));
+			Stats.EventLoopDelayP50Ms = (*Section)->GetNumberField(TEXT("p50"));
+			Stats.EventLoopDelayP99Ms = (*Section)->GetNumberField(TEXT("p99"));
+			Stats.EventLoopDelayMaxMs = (*Section)->GetNumberField(TEXT("max"));
+		}
+		if (Obj->TryGetObjectField(TEXT("cpu"), Section))
+		{
+			Stats.CpuUserMs = (*Section)->GetNumberField(TEXT("user"));
+			Stats.CpuSystemMs = (*Section)->GetNumberField(TEXT("system"));
+		}
+		if (Obj->TryGetObjectField(TEXT("memory"), Section))
+		{
+			Stats.RssBytes = (int64)(*Section)->GetNumberField(TEXT("rss"));
+			Stats.HeapUsedBytes = (int64)(*Section)->GetNumberField(TEXT("heapUsed"));
+			Stats.HeapTotalBytes = (int64)(*Section)->GetNumberField(TEXT("heapTotal"));
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [this, Stats]
 		{
-			OnEvent.Broadcast(EventName, ArgsJson, FirstBuffer);
+			LatestRuntimeStats.Add(Stats.Script, Stats);
+			OnRuntimeStats.Broadcast(Stats);
 		});
 		break;
 	}
+	case ENodeFrameType::Trace:
+	{
+		//node-side hops of an event we sent: {id, hops:[[stage, micros], ...]}. Per-target traces of a
+		//multicast also carry {parent, name, script}
+		TSharedPtr<FJsonObject> Obj;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Header);
+		const TArray<TSharedPtr<FJsonValue>>* Hops = nullptr;
+		if (EventTracer.IsEnabled() && FJsonSerializer::Deserialize(Reader, Obj) && Obj.IsValid() && Obj->TryGetArrayField(TEXT("hops"), Hops))
+		{
+			FString EventName, ScriptName;
+			double ParentId = 0;
+			Obj->TryGetStringField(TEXT("name"), EventName);
+			Obj->TryGetStringField(TEXT("script"), ScriptName);
+			Obj->TryGetNumberField(TEXT("parent"), ParentId);
+			EventTracer.AddNodeHops((uint64)Obj->GetNumberField(TEXT("id")), *Hops, EventName, ScriptName, (uint64)ParentId);
+		}
+		break;
+	}
+	case ENodeFrameType::Stream:
+	{
+		HandleStreamFrame(Header, Binary);
+		break;
+	}
+	case ENodeFrameType::TickResult:
+	{
+		//Handled right here: the game thread is blocked waiting for it
+		HandleTickResult(Header, Binary);
+		break;
+	}
 	case ENodeFrameType::Error:
 	{
 		TSharedPtr<FJsonObject> Obj;
@@ -335,6 +1313,17 @@ void UNodeComponent::InitializeComponent()
 {
 	Super::InitializeComponent();
 
+	{
+		FScopeLock ScopeLock(&DispatchPolicyLock);
+		ActiveDispatchPolicies = EventDispatchPolicies;
+	}
+
+	LockstepSignal = FPlatformProcess::GetSynchEventFromPool(false);
+	BackgroundTasksIdle = FPlatformProcess::GetSynchEventFromPool(false);
+
+	bOutboundClosed = false;
+	bOutboundPumpActive = false;
+
 	//handle script at startup if relevant
 	OnBeginProcessing.AddDynamic(this, &UNodeComponent::BeginProcessingExtraHandler);
 
@@ -346,26 +1335,103 @@ void UNodeComponent::InitializeComponent()
 	//All output arrives framed via the bytes channel; feed the decoder.
 	ProcessHandler->OnProcessOutputBytes = [this](const int32 ProcessId, const TArray<uint8>& OutputBytes)
 	{
+		StreamRecorder.Record(ENodeStreamDirection::FromNode, OutputBytes.GetData(), OutputBytes.Num());
 		Decoder.Feed(OutputBytes);
 	};
 }
 
 void UNodeComponent::UninitializeComponent()
 {
+	bCancelReplay = true;
+	if (ReplayTask.IsValid())
+	{
+		ReplayTask.Wait();
+	}
+
+	//Stop the outbound pump and event dispatch
+	bOutboundClosed = true;
+	{
+		FScopeLock ScopeLock(&BackgroundDispatchLock);
+		BackgroundDispatchQueues.Empty();
+	}
+
+	//Stop node first: a bulk pump blocked in SendInput on a full pipe is released once the pipe closes
+	if (bProcessIsRunning)
+	{
+		StopProcess();
+	}
+
+	//Wait out background tasks that still hold this, but never hang teardown on a stuck handler
+	static const double BackgroundTaskTimeoutSeconds = 2.0;
+	const double WaitUntil = FPlatformTime::Seconds() + BackgroundTaskTimeoutSeconds;
+	while (BackgroundTasks > 0)
+	{
+		const double Remaining = WaitUntil - FPlatformTime::Seconds();
+		if (Remaining <= 0.0 || !BackgroundTasksIdle->Wait(FTimespan::FromSeconds(Remaining)))
+		{
+			break;
+		}
+	}
+	{
+		FScopeLock ScopeLock(&BackgroundTasksLock);
+		if (BackgroundTasks > 0)
+		{
+			//Keep the event alive for the stragglers rather than handing it back to the pool
+			UE_LOG(LogNodeJs, Error, TEXT("%d NodeJs background task(s) still running after %.0fs at teardown (blocked OnEventNative handler?)"), BackgroundTasks.load(), BackgroundTaskTimeoutSeconds);
+		}
+		else
+		{
+			FPlatformProcess::ReturnSynchEventToPool(BackgroundTasksIdle);
+			BackgroundTasksIdle = nullptr;
+		}
+	}
+
+	//Anything still queued for node is dropped: the process is gone
+	AbortOpenStreams(TEXT("component uninitialized"));
+	StreamRecorder.Close();
+	OutboundLanes.Reset();
+	DeltaDecoder.Reset();
+
+	{
+		//Under the lock: a late tick result on the reader thread checks it before triggering
+		FScopeLock ScopeLock(&LockstepLock);
+		AwaitedLockstepFrame = 0;
+		if (LockstepSignal)
+		{
+			FPlatformProcess::ReturnSynchEventToPool(LockstepSignal);
+			LockstepSignal = nullptr;
+		}
+	}
 	Super::UninitializeComponent();
 }
 
 void UNodeComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	if (NodeJsProcessParams.bLockstep)
+	{
+		SetComponentTickEnabled(true);
+	}
 }
 
 void UNodeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	//Don't lose a trace that was started from the process params.
+	if (EventTracer.IsEnabled())
+	{
+		StopEventTrace();
+	}
+
 	Super::EndPlay(EndPlayReason);
 }
 
 void UNodeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (NodeJsProcessParams.bLockstep && bProcessIsRunning && LockstepSignal)
+	{
+		RunLockstepTick(DeltaTime);
+	}
 }
@@ -0,0 +1,180 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+
+#include "NodeDeltaDecoder.h"
+#include "Json.h"
+
+FNodeDeltaDecoder::EResult FNodeDeltaDecoder::Apply(const FString& StreamKey, const FJsonObject& Delta, TArray<TSharedPtr<FJsonValue>>& InOutArgs, TArray<TArray<uint8>>& InOutBuffers)
+{
+	FDeltaState& State = States.FindOrAdd(StreamKey);
+
+	double Seq = 0;
+	if (!Delta.TryGetNumberField(TEXT("seq"), Seq))
+	{
+		return Resync(State);
+	}
+
+	//Keyframe: the frame already carries the full value, remember it
+	if (Delta.HasField(TEXT("key")))
+	{
+		State.Seq = (int64)Seq;
+		State.Args = MakeShared<FJsonValueArray>(InOutArgs);
+		State.Buffers = InOutBuffers;
+		State.bKeyframeRequested = false;
+		return EResult::Applied;
+	}
+
+	double Base = 0;
+	double BufferCount = 0;
+	if (!State.Args.IsValid() || !Delta.TryGetNumberField(TEXT("base"), Base) || (int64)Base != State.Seq
+		|| !Delta.TryGetNumberField(TEXT("bufs"), BufferCount) || BufferCount < 0)
+	{
+		return Resync(State);
+	}
+
+	//ops: ["s", path, value] | ["d", path]
+	const TArray<TSharedPtr<FJsonValue>>* Ops = nullptr;
+	if (Delta.TryGetArrayField(TEXT("ops"), Ops))
+	{
+		for (const TSharedPtr<FJsonValue>& OpValue : *Ops)
+		{
+			const TArray<TSharedPtr<FJsonValue>>& Op = OpValue->AsArray();
+			if (Op.Num() < 2 || Op[1]->Type != EJson::Array)
+			{
+				continue;
+			}
+			const bool bSet = Op[0]->AsString() == TEXT("s");
+			const TSharedPtr<FJsonValue> Value = bSet && Op.Num() > 2 ? Op[2] : nullptr;
+			if (!SetPath(State.Args, Op[1]->AsArray(), 0, Value))
+			{
+				//Path runs through something we don't hold: out of sync, rebuild from a keyframe
+				return Resync(State);
+			}
+		}
+	}
+
+	//bins: [buffer, offset, table index]; offset -1 replaces the whole buffer
+	const TArray<TArray<uint8>> Table = MoveTemp(InOutBuffers);
+	State.Buffers.SetNum((int32)BufferCount);
+
+	const TArray<TSharedPtr<FJsonValue>>* Bins = nullptr;
+	if (Delta.TryGetArrayField(TEXT("bins"), Bins))
+	{
+		for (const TSharedPtr<FJsonValue>& BinValue : *Bins)
+		{
+			const TArray<TSharedPtr<FJsonValue>>& Bin = BinValue->AsArray();
+			if (Bin.Num() < 3)
+			{
+				continue;
+			}
+			const int32 BufferIndex = (int32)Bin[0]->AsNumber();
+			const int64 Offset = (int64)Bin[1]->AsNumber();
+			const int32 TableIndex = (int32)Bin[2]->AsNumber();
+
+			//A patch we can't place means our buffers no longer match the sender's
+			if (!State.Buffers.IsValidIndex(BufferIndex) || !Table.IsValidIndex(TableIndex))
+			{
+				return Resync(State);
+			}
+
+			TArray<uint8>& Target = State.Buffers[BufferIndex];
+			const TArray<uint8>& Patch = Table[TableIndex];
+			if (Offset < 0)
+			{
+				Target = Patch;
+			}
+			else if (Offset + Patch.Num() <= Target.Num())
+			{
+				FMemory::Memcpy(Target.GetData() + Offset, Patch.GetData(), Patch.Num());
+			}
+			else
+			{
+				return Resync(State);
+			}
+		}
+	}
+
+	State.Seq = (int64)Seq;
+	InOutArgs = State.Args->AsArray();
+	InOutBuffers = State.Buffers;
+	return EResult::Applied;
+}
+
+FNodeDeltaDecoder::EResult FNodeDeltaDecoder::Resync(FDeltaState& State)
+{
+	//Whatever we hold can't be trusted anymore; ask once, then drop updates until the keyframe lands
+	State.Args.Reset();
+	State.Buffers.Reset();
+	const bool bAlreadyRequested = State.bKeyframeRequested;
+	State.bKeyframeRequested = true;
+	return bAlreadyRequested ? EResult::Dropped : EResult::NeedKeyframe;
+}
+
+void FNodeDeltaDecoder::Reset()
+{
+	States.Empty();
+}
+
+bool FNodeDeltaDecoder::SetPath(TSharedPtr<FJsonValue>& Node, const TArray<TSharedPtr<FJsonValue>>& Path, int32 Depth, const TSharedPtr<FJsonValue>& Value)
+{
+	if (Depth >= Path.Num())
+	{
+		Node = Value;
+		return true;
+	}
+	if (!Node.IsValid())
+	{
+		return false;
+	}
+
+	const bool bLast = Depth == Path.Num() - 1;
+
+	if (Node->Type == EJson::Object)
+	{
+		const TSharedPtr<FJsonObject> Obj = Node->AsObject();
+		const FString Key = Path[Depth]->AsString();
+		if (bLast)
+		{
+			if (Value.IsValid())
+			{
+				Obj->SetField(Key, Value);
+			}
+			else
+			{
+				Obj->RemoveField(Key);
+			}
+			return true;
+		}
+
+		//Intermediate keys must exist; the encoder only descends into values it sent before
+		TSharedPtr<FJsonValue> Child = Obj->TryGetField(Key);
+		if (!SetPath(Child, Path, Depth + 1, Value))
+		{
+			return false;
+		}
+		Obj->SetField(Key, Child);
+		return true;
+	}
+
+	if (Node->Type == EJson::Array)
+	{
+		TArray<TSharedPtr<FJsonValue>> Elements = Node->AsArray();
+		const int32 Index = (int32)Path[Depth]->AsNumber();
+		if (!Elements.IsValidIndex(Index))
+		{
+			return false;
+		}
+		if (bLast && !Value.IsValid())
+		{
+			Elements.RemoveAt(Index);
+		}
+		else if (!SetPath(Elements[Index], Path, Depth + 1, Value))
+		{
+			return false;
+		}
+		Node = MakeShared<FJsonValueArray>(Elements);
+		return true;
+	}
+
+	//Path runs through a scalar
+	return false;
+}
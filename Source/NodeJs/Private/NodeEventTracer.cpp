@@ -0,0 +1,207 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+
+#include "NodeEventTracer.h"
+#include "NodeJs.h"
+#include "Dom/JsonValue.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+namespace
+{
+	// Stop collecting past this many events so a forgotten trace can't eat memory.
+	constexpr int32 MaxTraces = 200000;
+
+	// Chrome trace process ids for the two sides of the bridge.
+	constexpr int32 UnrealPid = 1;
+	constexpr int32 NodePid = 2;
+}
+
+int64 FNodeEventTracer::NowMicros()
+{
+	// FDateTime is coarse on some platforms; anchor it once and advance with the
+	// high resolution clock.
+	static const double EpochOffsetMicros = (double)((FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTicks() / ETimespan::TicksPerMicrosecond) - FPlatformTime::Seconds() * 1000000.0;
+	return (int64)(EpochOffsetMicros + FPlatformTime::Seconds() * 1000000.0);
+}
+
+void FNodeEventTracer::Start()
+{
+	bEnabled = true;
+}
+
+void FNodeEventTracer::Stop()
+{
+	bEnabled = false;
+}
+
+uint64 FNodeEventTracer::NewTraceId()
+{
+	return NextTraceId++;
+}
+
+FNodeEventTracer::FTrace* FNodeEventTracer::FindOrAddLocked(uint64 TraceId, const FString& EventName, const FString& ScriptName, uint64 ParentId)
+{
+	FTrace* Trace = Traces.Find(TraceId);
+	if (!Trace)
+	{
+		if (Traces.Num() >= MaxTraces)
+		{
+			return nullptr;
+		}
+		Trace = &Traces.Add(TraceId);
+	}
+	if (Trace->EventName.IsEmpty())
+	{
+		Trace->EventName = EventName;
+	}
+	if (Trace->ScriptName.IsEmpty())
+	{
+		Trace->ScriptName = ScriptName;
+	}
+	if (Trace->ParentId == 0)
+	{
+		Trace->ParentId = ParentId;
+	}
+	return Trace;
+}
+
+void FNodeEventTracer::AddHop(uint64 TraceId, const TCHAR* Stage, int64 Micros, bool bNodeSide, const FString& EventName, const FString& ScriptName, uint64 ParentId)
+{
+	//Unreal-side hops are stamped as they happen: mirror them into Insights as bookmarks
+	TRACE_BOOKMARK(TEXT("NodeJs %llu %s"), TraceId, Stage);
+
+	FScopeLock ScopeLock(&Lock);
+	if (FTrace* Trace = FindOrAddLocked(TraceId, EventName, ScriptName, ParentId))
+	{
+		Trace->Hops.Add({ Stage, Micros, bNodeSide });
+	}
+}
+
+void FNodeEventTracer::AddNodeHops(uint64 TraceId, const TArray<TSharedPtr<FJsonValue>>& Hops, const FString& EventName, const FString& ScriptName, uint64 ParentId)
+{
+	FScopeLock ScopeLock(&Lock);
+	FTrace* Trace = FindOrAddLocked(TraceId, EventName, ScriptName, ParentId);
+	if (!Trace)
+	{
+		return;
+	}
+
+	//node hops arrive after the fact; Insights gets one bookmark per batch with offsets from its first hop
+	FString Summary;
+	int64 FirstMicros = 0;
+	for (const TSharedPtr<FJsonValue>& Hop : Hops)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Pair = nullptr;
+		if (Hop.IsValid() && Hop->TryGetArray(Pair) && Pair->Num() >= 2)
+		{
+			const FHop& Added = Trace->Hops.Add_GetRef({ (*Pair)[0]->AsString(), (int64)(*Pair)[1]->AsNumber(), true });
+			if (Summary.IsEmpty())
+			{
+				FirstMicros = Added.Micros;
+				Summary = Added.Stage;
+			}
+			else
+			{
+				Summary += FString::Printf(TEXT(" %s+%lldus"), *Added.Stage, Added.Micros - FirstMicros);
+			}
+		}
+	}
+	if (!Summary.IsEmpty())
+	{
+		TRACE_BOOKMARK(TEXT("NodeJs %llu node %s"), TraceId, *Summary);
+	}
+}
+
+void FNodeEventTracer::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Traces.Reset();
+}
+
+bool FNodeEventTracer::WriteChromeTrace(const FString& Filename) const
+{
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+
+	auto WriteProcessName = [&Writer](int32 Pid, const TCHAR* Name)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("ph"), TEXT("M"));
+		Writer->WriteValue(TEXT("name"), TEXT("process_name"));
+		Writer->WriteValue(TEXT("pid"), Pid);
+		Writer->WriteObjectStart(TEXT("args"));
+		Writer->WriteValue(TEXT("name"), Name);
+		Writer->WriteObjectEnd();
+		Writer->WriteObjectEnd();
+	};
+
+	// Async begin/end pair; slices with the same id nest into one track.
+	auto WriteAsync = [&Writer](const TCHAR* Phase, const FString& Name, uint64 Id, int64 Micros, int32 Pid, const FString& Script, uint64 ParentId)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("ph"), Phase);
+		Writer->WriteValue(TEXT("cat"), TEXT("nodejs"));
+		Writer->WriteValue(TEXT("name"), Name);
+		Writer->WriteValue(TEXT("id"), FString::Printf(TEXT("0x%llx"), Id));
+		Writer->WriteValue(TEXT("ts"), Micros);
+		Writer->WriteValue(TEXT("pid"), Pid);
+		Writer->WriteValue(TEXT("tid"), 1);
+		if (Phase[0] == TEXT('b'))
+		{
+			Writer->WriteObjectStart(TEXT("args"));
+			Writer->WriteValue(TEXT("script"), Script);
+			if (ParentId != 0)
+			{
+				Writer->WriteValue(TEXT("parent"), FString::Printf(TEXT("0x%llx"), ParentId));
+			}
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteObjectEnd();
+	};
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("displayTimeUnit"), TEXT("ms"));
+	Writer->WriteArrayStart(TEXT("traceEvents"));
+	WriteProcessName(UnrealPid, TEXT("Unreal"));
+	WriteProcessName(NodePid, TEXT("node"));
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		for (const TPair<uint64, FTrace>& Pair : Traces)
+		{
+			TArray<FHop> Hops = Pair.Value.Hops;
+			if (Hops.Num() < 2)
+			{
+				continue;
+			}
+			Hops.StableSort([](const FHop& A, const FHop& B) { return A.Micros < B.Micros; });
+
+			const FString& Script = Pair.Value.ScriptName;
+			const int32 FirstPid = Hops[0].bNodeSide ? NodePid : UnrealPid;
+			WriteAsync(TEXT("b"), Pair.Value.EventName, Pair.Key, Hops[0].Micros, FirstPid, Script, Pair.Value.ParentId);
+
+			// Each hop is attributed to the side that stamped its end.
+			for (int32 i = 1; i < Hops.Num(); ++i)
+			{
+				const FString HopName = Hops[i - 1].Stage + TEXT(" -> ") + Hops[i].Stage;
+				const int32 Pid = Hops[i].bNodeSide ? NodePid : UnrealPid;
+				WriteAsync(TEXT("b"), HopName, Pair.Key, Hops[i - 1].Micros, Pid, Script, 0);
+				WriteAsync(TEXT("e"), HopName, Pair.Key, Hops[i].Micros, Pid, Script, 0);
+			}
+
+			WriteAsync(TEXT("e"), Pair.Value.EventName, Pair.Key, Hops.Last().Micros, FirstPid, Script, 0);
+		}
+	}
+
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	if (!FFileHelper::SaveStringToFile(Json, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogNodeJs, Warning, TEXT("Could not write event trace '%s'"), *Filename);
+		return false;
+	}
+	return true;
+}
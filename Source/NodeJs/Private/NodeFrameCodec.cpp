@@ -52,6 +52,24 @@ TArray<uint8> FNodeFrameCodec::Encode(uint8 Type, const FString& Header)
 	return Encode(Type, Header, Empty);
 }
 
+TArray<uint8> FNodeFrameCodec::EncodeFragment(uint32 FragmentId, bool bLast, const uint8* Slice, int32 SliceLen)
+{
+	TArray<uint8> Out;
+	Out.Reserve(PreHeaderSize + 4 + 5 + SliceLen);
+
+	Out.Append(Magic, 4);
+	Out.Add(ENodeFrameType::Fragment);
+	WriteU32(Out, 0);
+	WriteU32(Out, (uint32)(5 + SliceLen));
+	WriteU32(Out, FragmentId);
+	Out.Add(bLast ? 0x01 : 0x00);
+	if (SliceLen > 0)
+	{
+		Out.Append(Slice, SliceLen);
+	}
+	return Out;
+}
+
 TArray<uint8> FNodeFrameCodec::BuildBinaryTable(const TArray<TArray<uint8>>& Buffers)
 {
 	TArray<uint8> Out;
@@ -100,9 +118,21 @@ bool FNodeFrameCodec::ParseBinaryTable(const TArray<uint8>& Table, TArray<TArray
 	return true;
 }
 
+void FNodeFrameCodec::Reset()
+{
+	Accum.Reset();
+	Partials.Reset();
+	PartialBytes = 0;
+}
+
 void FNodeFrameCodec::Feed(const TArray<uint8>& Chunk)
 {
-	Accum.Append(Chunk);
+	Feed(Chunk.GetData(), Chunk.Num());
+}
+
+void FNodeFrameCodec::Feed(const uint8* Data, int32 Num)
+{
+	Accum.Append(Data, Num);
 	TryParse();
 }
 
@@ -130,10 +160,144 @@ int32 FNodeFrameCodec::FindMagicFrom(int32 Start) const
 	return INDEX_NONE;
 }
 
+bool FNodeFrameCodec::DecodeAt(const TArray<uint8>& Buffer, int32 Start, int32& OutEnd, uint8& OutType, FString& OutHeader, TArray<uint8>& OutBinary)
+{
+	if (Buffer.Num() - Start < PreHeaderSize)
+	{
+		return false;
+	}
+
+	int32 P = Start + 4;
+	const uint8 Type = Buffer[P];
+	P += 1;
+
+	const uint32 HeaderLen = ReadU32(Buffer, P);
+	P += 4;
+
+	// Wait for the full header + the binary length field.
+	if (Buffer.Num() < P + (int32)HeaderLen + 4)
+	{
+		return false;
+	}
+
+	const int32 HeaderStart = P;
+	P += HeaderLen;
+
+	const uint32 BinaryLen = ReadU32(Buffer, P);
+	P += 4;
+
+	// Wait for the full binary payload.
+	if (Buffer.Num() < P + (int32)BinaryLen)
+	{
+		return false;
+	}
+
+	OutType = Type;
+	OutHeader.Reset();
+	if (HeaderLen > 0)
+	{
+		FUTF8ToTCHAR Conv((const ANSICHAR*)(Buffer.GetData() + HeaderStart), (int32)HeaderLen);
+		OutHeader = FString(Conv.Length(), Conv.Get());
+	}
+
+	OutBinary.Reset();
+	if (BinaryLen > 0)
+	{
+		OutBinary.Append(Buffer.GetData() + P, BinaryLen);
+	}
+	P += BinaryLen;
+
+	OutEnd = P;
+	return true;
+}
+
+void FNodeFrameCodec::HandleFragment(const TArray<uint8>& Binary)
+{
+	// id(4) + flags(1)
+	if (Binary.Num() < 5)
+	{
+		return;
+	}
+	const uint32 FragmentId = ReadU32(Binary, 0);
+	const bool bLast = (Binary[4] & 0x01) != 0;
+	const int32 SliceLen = Binary.Num() - 5;
+
+	//Bound what reassembly can hold: stale partials (e.g. from a killed sender) are evicted
+	if (!Partials.Contains(FragmentId) && Partials.Num() >= MaxPartialFrames)
+	{
+		EvictStalestPartial(FragmentId);
+	}
+	while (PartialBytes + SliceLen > MaxPartialBytes && Partials.Num() > 0 && !(Partials.Num() == 1 && Partials.Contains(FragmentId)))
+	{
+		EvictStalestPartial(FragmentId);
+	}
+
+	FPartialFrame& Partial = Partials.FindOrAdd(FragmentId);
+	if (Partial.Bytes.Num() + (int64)SliceLen > MaxPartialBytes)
+	{
+		//A single frame over the cap can't be reassembled; drop it and whatever follows under its id
+		PartialBytes -= Partial.Bytes.Num();
+		Partials.Remove(FragmentId);
+		return;
+	}
+	Partial.Bytes.Append(Binary.GetData() + 5, SliceLen);
+	Partial.LastTouched = ++FragmentsSeen;
+	PartialBytes += SliceLen;
+
+	if (!bLast)
+	{
+		return;
+	}
+
+	TArray<uint8> Assembled = MoveTemp(Partial.Bytes);
+	Partials.Remove(FragmentId);
+	PartialBytes -= Assembled.Num();
+
+	uint8 Type = 0;
+	FString Header;
+	TArray<uint8> InnerBinary;
+	int32 End = 0;
+	if (Assembled.Num() < 4 || Assembled[0] != Magic[0] || Assembled[1] != Magic[1] || Assembled[2] != Magic[2] || Assembled[3] != Magic[3]
+		|| !DecodeAt(Assembled, 0, End, Type, Header, InnerBinary))
+	{
+		// Corrupt reassembly; drop it like any other unparseable bytes.
+		return;
+	}
+
+	if (OnFrame)
+	{
+		OnFrame(Type, Header, InnerBinary);
+	}
+}
+
+void FNodeFrameCodec::EvictStalestPartial(uint32 KeepId)
+{
+	uint32 StalestId = 0;
+	uint64 StalestTouched = MAX_uint64;
+	for (const TPair<uint32, FPartialFrame>& Pair : Partials)
+	{
+		if (Pair.Key != KeepId && Pair.Value.LastTouched < StalestTouched)
+		{
+			StalestId = Pair.Key;
+			StalestTouched = Pair.Value.LastTouched;
+		}
+	}
+	if (StalestTouched == MAX_uint64)
+	{
+		return;
+	}
+	PartialBytes -= Partials[StalestId].Bytes.Num();
+	Partials.Remove(StalestId);
+}
+
 void FNodeFrameCodec::TryParse()
 {
 	int32 Cursor = 0;
 
+	uint8 Type = 0;
+	FString Header;
+	TArray<uint8> Binary;
+
 	while (true)
 	{
 		// Need enough to read the magic + type + header length.
@@ -157,49 +321,22 @@ void FNodeFrameCodec::TryParse()
 			continue;
 		}
 
-		int32 P = Cursor + 4;
-		const uint8 Type = Accum[P];
-		P += 1;
-
-		const uint32 HeaderLen = ReadU32(Accum, P);
-		P += 4;
-
-		// Wait for the full header + the binary length field.
-		if (Accum.Num() < P + (int32)HeaderLen + 4)
-		{
-			break;
-		}
-
-		FString Header;
-		if (HeaderLen > 0)
-		{
-			FUTF8ToTCHAR Conv((const ANSICHAR*)(Accum.GetData() + P), (int32)HeaderLen);
-			Header = FString(Conv.Length(), Conv.Get());
-		}
-		P += HeaderLen;
-
-		const uint32 BinaryLen = ReadU32(Accum, P);
-		P += 4;
-
-		// Wait for the full binary payload.
-		if (Accum.Num() < P + (int32)BinaryLen)
+		int32 End = 0;
+		if (!DecodeAt(Accum, Cursor, End, Type, Header, Binary))
 		{
 			break;
 		}
 
-		TArray<uint8> Binary;
-		if (BinaryLen > 0)
+		if (Type == ENodeFrameType::Fragment)
 		{
-			Binary.Append(Accum.GetData() + P, BinaryLen);
+			HandleFragment(Binary);
 		}
-		P += BinaryLen;
-
-		if (OnFrame)
+		else if (OnFrame)
 		{
 			OnFrame(Type, Header, Binary);
 		}
 
-		Cursor = P;
+		Cursor = End;
 	}
 
 	if (Cursor > 0)
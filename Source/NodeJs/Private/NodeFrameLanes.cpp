@@ -0,0 +1,120 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+
+#include "NodeFrameLanes.h"
+#include "NodeFrameCodec.h"
+
+void FNodeFrameLanes::SetSizes(int32 InBulkThreshold, int32 InFragmentSize)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	BulkThreshold = InBulkThreshold;
+	FragmentSize = InFragmentSize;
+}
+
+void FNodeFrameLanes::Enqueue(TArray<uint8>&& Frame, ENodeFrameLane::Type Lane, uint64 TraceId)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (Frame.Num() > BulkThreshold)
+	{
+		Lane = ENodeFrameLane::Bulk;
+	}
+
+	FPendingFrame& Pending = Lanes[Lane].AddDefaulted_GetRef();
+	Pending.Bytes = MoveTemp(Frame);
+	Pending.TraceId = TraceId;
+	if (Lane == ENodeFrameLane::Bulk)
+	{
+		Pending.FragmentId = NextFragmentId++;
+	}
+}
+
+bool FNodeFrameLanes::PopNext(TArray<uint8>& OutBytes, bool bIncludeBulk, uint64* OutTraceId)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (OutTraceId)
+	{
+		*OutTraceId = 0;
+	}
+
+	for (int32 LaneIndex = 0; LaneIndex < ENodeFrameLane::Count; ++LaneIndex)
+	{
+		TArray<FPendingFrame>& Lane = Lanes[LaneIndex];
+		if (Lane.Num() == 0)
+		{
+			continue;
+		}
+
+		if (LaneIndex != ENodeFrameLane::Bulk)
+		{
+			if (OutTraceId)
+			{
+				*OutTraceId = Lane[0].TraceId;
+			}
+			OutBytes = MoveTemp(Lane[0].Bytes);
+			Lane.RemoveAt(0, 1, EAllowShrinking::No);
+			return true;
+		}
+
+		if (!bIncludeBulk)
+		{
+			return false;
+		}
+
+		//Frames queued on the bulk lane explicitly may be small; those go out whole.
+		FPendingFrame& Pending = Lane[0];
+		if (Pending.Offset == 0 && Pending.Bytes.Num() <= FragmentSize)
+		{
+			if (OutTraceId)
+			{
+				*OutTraceId = Pending.TraceId;
+			}
+			OutBytes = MoveTemp(Pending.Bytes);
+			Lane.RemoveAt(0, 1, EAllowShrinking::No);
+			return true;
+		}
+
+		//Cut the next fragment off the front bulk frame.
+		const int32 SliceLen = FMath::Min(FragmentSize, Pending.Bytes.Num() - Pending.Offset);
+		const bool bLast = Pending.Offset + SliceLen >= Pending.Bytes.Num();
+
+		OutBytes = FNodeFrameCodec::EncodeFragment(Pending.FragmentId, bLast, Pending.Bytes.GetData() + Pending.Offset, SliceLen);
+		Pending.Offset += SliceLen;
+
+		if (bLast)
+		{
+			if (OutTraceId)
+			{
+				*OutTraceId = Pending.TraceId;
+			}
+			Lane.RemoveAt(0, 1, EAllowShrinking::No);
+		}
+		return true;
+	}
+	return false;
+}
+
+bool FNodeFrameLanes::HasPending() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	for (int32 LaneIndex = 0; LaneIndex < ENodeFrameLane::Count; ++LaneIndex)
+	{
+		if (Lanes[LaneIndex].Num() > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FNodeFrameLanes::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+
+	for (int32 LaneIndex = 0; LaneIndex < ENodeFrameLane::Count; ++LaneIndex)
+	{
+		Lanes[LaneIndex].Reset();
+	}
+}
@@ -0,0 +1,228 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+
+#include "NodeStreamRecorder.h"
+#include "NodeJs.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+
+namespace
+{
+	const uint8 RecordingMagic[4] = { 'N', 'U', 'E', 'R' };
+	constexpr uint8 RecordingVersion = 1;
+
+	// magic(4) + version(1) + reserved(3)
+	constexpr int32 FileHeaderSize = 8;
+
+	// timestamp(8) + direction(1) + length(4)
+	constexpr int32 RecordHeaderSize = 13;
+
+	// Buffered bytes before the recorder touches the file.
+	constexpr int32 FlushThreshold = 1024 * 1024;
+
+	FORCEINLINE void WriteLE(TArray<uint8>& Out, uint64 Value, int32 Bytes)
+	{
+		for (int32 i = 0; i < Bytes; ++i)
+		{
+			Out.Add((uint8)((Value >> (8 * i)) & 0xFF));
+		}
+	}
+
+	FORCEINLINE uint64 ReadLE(const uint8* In, int32 Bytes)
+	{
+		uint64 Value = 0;
+		for (int32 i = 0; i < Bytes; ++i)
+		{
+			Value |= (uint64)In[i] << (8 * i);
+		}
+		return Value;
+	}
+}
+
+//~ FNodeStreamRecorder ----------------------------------------------------
+
+FNodeStreamRecorder::~FNodeStreamRecorder()
+{
+	Close();
+}
+
+bool FNodeStreamRecorder::Open(const FString& Filename)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+
+	IFileHandle* NewFile = PlatformFile.OpenWrite(*Filename);
+	if (!NewFile)
+	{
+		UE_LOG(LogNodeJs, Warning, TEXT("Could not open stream recording '%s'"), *Filename);
+		return false;
+	}
+
+	{
+		FScopeLock WriteScope(&WriteLock);
+		File.Reset(NewFile);
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	Pending.Reset();
+	Pending.Append(RecordingMagic, 4);
+	Pending.Add(RecordingVersion);
+	Pending.AddZeroed(3);
+
+	StartSeconds = FPlatformTime::Seconds();
+	bIsRecording = true;
+	return true;
+}
+
+void FNodeStreamRecorder::Close()
+{
+	FScopeLock ScopeLock(&Lock);
+	bIsRecording = false;
+	const TArray<uint8> Block = MoveTemp(Pending);
+	Pending.Reset();
+
+	FScopeLock WriteScope(&WriteLock);
+	ScopeLock.Unlock();
+
+	WriteBlock(Block);
+	File.Reset();
+}
+
+void FNodeStreamRecorder::Record(ENodeStreamDirection::Type Direction, const uint8* Data, int32 Num)
+{
+	if (!bIsRecording)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	if (!bIsRecording)
+	{
+		return;
+	}
+
+	//Stamped under the lock so timestamps follow record order
+	const uint64 Micros = (uint64)((FPlatformTime::Seconds() - StartSeconds) * 1000000.0);
+
+	WriteLE(Pending, Micros, 8);
+	Pending.Add(Direction);
+	WriteLE(Pending, (uint32)Num, 4);
+	Pending.Append(Data, Num);
+
+	if (Pending.Num() < FlushThreshold)
+	{
+		return;
+	}
+
+	const TArray<uint8> Block = MoveTemp(Pending);
+	Pending.Reset();
+
+	//Hand over to the write lock before releasing ours: recorders keep going while this writes
+	FScopeLock WriteScope(&WriteLock);
+	ScopeLock.Unlock();
+	WriteBlock(Block);
+}
+
+void FNodeStreamRecorder::WriteBlock(const TArray<uint8>& Block)
+{
+	if (File.IsValid() && Block.Num() > 0)
+	{
+		File->Write(Block.GetData(), Block.Num());
+		File->Flush();
+	}
+}
+
+//~ FNodeStreamReplayer ----------------------------------------------------
+
+FNodeStreamReplayer::~FNodeStreamReplayer()
+{
+	Close();
+}
+
+bool FNodeStreamReplayer::Open(const FString& Filename)
+{
+	Close();
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!MappedFile.IsValid())
+	{
+		UE_LOG(LogNodeJs, Warning, TEXT("Could not map stream recording '%s'"), *Filename);
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize(), true));
+	if (!MappedRegion.IsValid()
+		|| MappedRegion->GetMappedSize() < FileHeaderSize
+		|| FMemory::Memcmp(MappedRegion->GetMappedPtr(), RecordingMagic, 4) != 0
+		|| MappedRegion->GetMappedPtr()[4] != RecordingVersion)
+	{
+		UE_LOG(LogNodeJs, Warning, TEXT("'%s' is not a NodeJs stream recording"), *Filename);
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FNodeStreamReplayer::Close()
+{
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+int32 FNodeStreamReplayer::Replay(ENodeStreamDirection::Type Direction, bool bRealtime, TFunctionRef<void(const uint8* Data, int32 Num)> Sink, const std::atomic<bool>* bCancel) const
+{
+	if (!MappedRegion.IsValid())
+	{
+		return 0;
+	}
+
+	const uint8* Data = MappedRegion->GetMappedPtr();
+	const int64 Size = MappedRegion->GetMappedSize();
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	int32 Played = 0;
+	int64 Cursor = FileHeaderSize;
+	while (Cursor + RecordHeaderSize <= Size)
+	{
+		if (bCancel && *bCancel)
+		{
+			break;
+		}
+
+		const uint64 Micros = ReadLE(Data + Cursor, 8);
+		const uint8 RecordDirection = Data[Cursor + 8];
+		const int64 Num = (int64)ReadLE(Data + Cursor + 9, 4);
+		Cursor += RecordHeaderSize;
+
+		if (Cursor + Num > Size)
+		{
+			// Truncated tail (recording not closed cleanly).
+			break;
+		}
+
+		if (RecordDirection == Direction)
+		{
+			if (bRealtime)
+			{
+				const double Due = StartSeconds + (double)Micros / 1000000.0;
+				const double Remaining = Due - FPlatformTime::Seconds();
+
+				// Sleep the bulk of the gap in short slices (so a cancel lands quickly),
+				// spin the last millisecond for accuracy.
+				for (double Left = Remaining; Left > 0.002 && !(bCancel && *bCancel); Left = Due - FPlatformTime::Seconds())
+				{
+					FPlatformProcess::Sleep((float)FMath::Min(Left - 0.001, 0.05));
+				}
+				while (FPlatformTime::Seconds() < Due && !(bCancel && *bCancel))
+				{
+					FPlatformProcess::Yield();
+				}
+			}
+			Sink(Data + Cursor, (int32)Num);
+			++Played;
+		}
+		Cursor += Num;
+	}
+	return Played;
+}
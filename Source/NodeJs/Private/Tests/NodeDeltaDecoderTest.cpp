@@ -0,0 +1,135 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+//
+// Automation tests for FNodeDeltaDecoder, fed with frames in the wire format
+// process.js produces (see the delta section of process.js).
+// Run from the Session Frontend or: -ExecCmds="Automation RunTests NodeJs.DeltaDecoder"
+
+#include "Misc/AutomationTest.h"
+#include "NodeDeltaDecoder.h"
+#include "Json.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace NodeDeltaDecoderTest
+{
+	static TSharedPtr<FJsonObject> ParseObject(const FString& Json)
+	{
+		TSharedPtr<FJsonObject> Obj;
+		FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Obj);
+		return Obj;
+	}
+
+	static TArray<TSharedPtr<FJsonValue>> ParseArray(const FString& Json)
+	{
+		TArray<TSharedPtr<FJsonValue>> Array;
+		FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Array);
+		return Array;
+	}
+
+	static TSharedPtr<FJsonObject> State(const TArray<TSharedPtr<FJsonValue>>& Args)
+	{
+		return Args.Num() > 0 && Args[0]->Type == EJson::Object ? Args[0]->AsObject() : MakeShared<FJsonObject>();
+	}
+
+	static TArray<uint8> Bytes(int32 Num, uint8 Fill)
+	{
+		TArray<uint8> Out;
+		Out.Init(Fill, Num);
+		return Out;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNodeDeltaDecoderTest, "NodeJs.DeltaDecoder", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FNodeDeltaDecoderTest::RunTest(const FString& Parameters)
+{
+	using namespace NodeDeltaDecoderTest;
+	using EResult = FNodeDeltaDecoder::EResult;
+
+	FNodeDeltaDecoder Decoder;
+	const FString Key = TEXT("deltaState.js\nstate");
+
+	//Keyframe is passed through and remembered
+	TArray<TSharedPtr<FJsonValue>> Args = ParseArray(TEXT("[{\"pos\":{\"x\":1,\"y\":2},\"tags\":[\"a\",\"b\"],\"hp\":10},{\"_bin\":0}]"));
+	TArray<TArray<uint8>> Buffers = { Bytes(1024, 0) };
+	TestTrue(TEXT("keyframe applied"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":1,\"key\":1}")), Args, Buffers) == EResult::Applied);
+
+	//Nested set, array element set, delete, and a buffer range patch
+	Args.Reset();
+	Buffers = { Bytes(256, 7) };
+	const FString Delta2 = TEXT("{\"seq\":2,\"base\":1,\"ops\":[[\"s\",[0,\"pos\",\"x\"],5],[\"s\",[0,\"tags\",1],\"c\"],[\"d\",[0,\"hp\"]]],\"bufs\":1,\"bins\":[[0,512,0]]}");
+	TestTrue(TEXT("delta applied"), Decoder.Apply(Key, *ParseObject(Delta2), Args, Buffers) == EResult::Applied);
+	TestEqual(TEXT("nested value set"), State(Args)->GetObjectField(TEXT("pos"))->GetNumberField(TEXT("x")), 5.0);
+	TestEqual(TEXT("untouched value kept"), State(Args)->GetObjectField(TEXT("pos"))->GetNumberField(TEXT("y")), 2.0);
+	TestEqual(TEXT("array element set"), State(Args)->GetArrayField(TEXT("tags"))[1]->AsString(), FString(TEXT("c")));
+	TestFalse(TEXT("key deleted"), State(Args)->HasField(TEXT("hp")));
+	TestEqual(TEXT("placeholder arg kept"), Args.Num(), 2);
+	TestTrue(TEXT("delta rebuilds the full buffer"), Buffers.Num() == 1 && Buffers[0].Num() == 1024 && Buffers[0][511] == 0 && Buffers[0][512] == 7 && Buffers[0][767] == 7 && Buffers[0][768] == 0);
+
+	//Whole buffer replaced (offset -1) and a key added under an existing object
+	Args.Reset();
+	Buffers = { Bytes(16, 9) };
+	const FString Delta3 = TEXT("{\"seq\":3,\"base\":2,\"ops\":[[\"s\",[0,\"pos\",\"z\"],3]],\"bufs\":1,\"bins\":[[0,-1,0]]}");
+	TestTrue(TEXT("replace applied"), Decoder.Apply(Key, *ParseObject(Delta3), Args, Buffers) == EResult::Applied);
+	TestEqual(TEXT("new key set under an existing object"), State(Args)->GetObjectField(TEXT("pos"))->GetNumberField(TEXT("z")), 3.0);
+	TestEqual(TEXT("earlier update kept"), State(Args)->GetObjectField(TEXT("pos"))->GetNumberField(TEXT("x")), 5.0);
+	TestTrue(TEXT("buffer replaced"), Buffers.Num() == 1 && Buffers[0].Num() == 16 && Buffers[0][0] == 9);
+
+	//Missed update: ask for a keyframe once, then drop until it lands
+	Args.Reset();
+	Buffers.Reset();
+	const FString Skipped = TEXT("{\"seq\":5,\"base\":4,\"ops\":[],\"bufs\":1,\"bins\":[]}");
+	TestTrue(TEXT("base mismatch requests a keyframe"), Decoder.Apply(Key, *ParseObject(Skipped), Args, Buffers) == EResult::NeedKeyframe);
+	TestTrue(TEXT("second mismatch is dropped"), Decoder.Apply(Key, *ParseObject(Skipped), Args, Buffers) == EResult::Dropped);
+
+	Args = ParseArray(TEXT("[{\"pos\":{\"x\":0}}]"));
+	Buffers.Reset();
+	TestTrue(TEXT("keyframe recovers"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":6,\"key\":1}")), Args, Buffers) == EResult::Applied);
+
+	//Path through a key we don't hold: rejected, not stored as a null value
+	Args.Reset();
+	const FString Orphan = TEXT("{\"seq\":7,\"base\":6,\"ops\":[[\"s\",[0,\"missing\",\"x\"],1]],\"bufs\":0,\"bins\":[]}");
+	TestTrue(TEXT("missing intermediate key requests a keyframe"), Decoder.Apply(Key, *ParseObject(Orphan), Args, Buffers) == EResult::NeedKeyframe);
+	const FString Next = TEXT("{\"seq\":8,\"base\":7,\"ops\":[[\"s\",[0,\"pos\",\"x\"],2]],\"bufs\":0,\"bins\":[]}");
+	TestTrue(TEXT("updates after a rejected delta wait for the keyframe"), Decoder.Apply(Key, *ParseObject(Next), Args, Buffers) == EResult::Dropped);
+
+	//Out of range array index and a path through a scalar are rejected the same way
+	Args = ParseArray(TEXT("[{\"list\":[1,2],\"n\":1}]"));
+	TestTrue(TEXT("keyframe after rejection"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":9,\"key\":1}")), Args, Buffers) == EResult::Applied);
+	Args.Reset();
+	TestTrue(TEXT("bad array index rejected"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":10,\"base\":9,\"ops\":[[\"s\",[0,\"list\",5,\"a\"],1]],\"bufs\":0,\"bins\":[]}")), Args, Buffers) == EResult::NeedKeyframe);
+
+	Args = ParseArray(TEXT("[{\"n\":1}]"));
+	Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":11,\"key\":1}")), Args, Buffers);
+	Args.Reset();
+	TestTrue(TEXT("path through a scalar rejected"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":12,\"base\":11,\"ops\":[[\"s\",[0,\"n\",\"x\"],1]],\"bufs\":0,\"bins\":[]}")), Args, Buffers) == EResult::NeedKeyframe);
+
+	//Buffer patches that don't fit what we hold are rejected instead of skipped
+	Args = ParseArray(TEXT("[{\"n\":1},{\"_bin\":0}]"));
+	Buffers = { Bytes(64, 0) };
+	TestTrue(TEXT("keyframe with a buffer"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":13,\"key\":1}")), Args, Buffers) == EResult::Applied);
+	Args.Reset();
+	Buffers = { Bytes(32, 1) };
+	TestTrue(TEXT("patch past the buffer end rejected"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":14,\"base\":13,\"ops\":[],\"bufs\":1,\"bins\":[[0,48,0]]}")), Args, Buffers) == EResult::NeedKeyframe);
+
+	Args = ParseArray(TEXT("[{\"n\":1},{\"_bin\":0}]"));
+	Buffers = { Bytes(64, 0) };
+	Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":15,\"key\":1}")), Args, Buffers);
+	Args.Reset();
+	Buffers = { Bytes(8, 1) };
+	TestTrue(TEXT("missing table entry rejected"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":16,\"base\":15,\"ops\":[],\"bufs\":1,\"bins\":[[0,0,3]]}")), Args, Buffers) == EResult::NeedKeyframe);
+
+	Args = ParseArray(TEXT("[{\"n\":1}]"));
+	Buffers.Reset();
+	Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":17,\"key\":1}")), Args, Buffers);
+	Args.Reset();
+	TestTrue(TEXT("missing bufs field rejected"), Decoder.Apply(Key, *ParseObject(TEXT("{\"seq\":18,\"base\":17,\"ops\":[],\"bins\":[]}")), Args, Buffers) == EResult::NeedKeyframe);
+
+	//Streams are independent
+	Args.Reset();
+	TestTrue(TEXT("unknown stream requests a keyframe"), Decoder.Apply(TEXT("other.js\nstate"), *ParseObject(TEXT("{\"seq\":2,\"base\":1,\"ops\":[],\"bufs\":0,\"bins\":[]}")), Args, Buffers) == EResult::NeedKeyframe);
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
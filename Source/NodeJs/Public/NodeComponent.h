@@ -6,6 +6,12 @@
 #include "CLIProcessComponent.h"
 #include "Components/ActorComponent.h"
 #include "NodeFrameCodec.h"
+#include "NodeFrameLanes.h"
+#include "NodeStreamRecorder.h"
+#include "NodeEventTracer.h"
+#include "NodeDeltaDecoder.h"
+#include "Async/Future.h"
+#include <atomic>
 #include "NodeComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNodeSciptBeginSignature, int32, ProcessId);
@@ -18,6 +24,88 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FNpmInstallResultSignature, bool, b
 // args array; Binary carries the first interweaved binary buffer (empty if none).
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FNodeEventSignature, const FString&, EventName, const FString&, JsonArgs, const TArray<uint8>&, Binary);
 
+// Thread-safe C++ counterpart of FNodeEventSignature carrying every interweaved buffer.
+// Broadcast on whichever thread the event's ENodeEventDispatch policy selects.
+DECLARE_TS_MULTICAST_DELEGATE_ThreeParams(FNodeEventNativeSignature, const FString& /*EventName*/, const FString& /*JsonArgs*/, const TArray<TArray<uint8>>& /*Buffers*/);
+
+// Stream delegates (C++ only). All fire on the pipe reader thread as frames arrive, so a
+// chunk handler that blocks also stalls the stream (and every other frame) behind it.
+DECLARE_TS_MULTICAST_DELEGATE_FourParams(FNodeStreamOpenNativeSignature, int32 /*StreamId*/, const FString& /*StreamName*/, const FString& /*ScriptName*/, int64 /*ExpectedSize, -1 if unknown*/);
+DECLARE_TS_MULTICAST_DELEGATE_ThreeParams(FNodeStreamChunkNativeSignature, int32 /*StreamId*/, const FString& /*StreamName*/, TArrayView<const uint8> /*Chunk*/);
+DECLARE_TS_MULTICAST_DELEGATE_FourParams(FNodeStreamEndNativeSignature, int32 /*StreamId*/, const FString& /*StreamName*/, int64 /*TotalBytes*/, bool /*bAborted*/);
+
+// Fired when node acks an outbound stream, i.e. WriteStream can accept more.
+DECLARE_TS_MULTICAST_DELEGATE_TwoParams(FNodeStreamWritableNativeSignature, int32 /*StreamId*/, int64 /*WritableBytes*/);
+
+// Fired when an outbound stream is closed without EndStream/AbortStream: node rejected it or the
+// process stopped. WriteStream returns false for it from then on.
+DECLARE_TS_MULTICAST_DELEGATE_TwoParams(FNodeStreamClosedNativeSignature, int32 /*StreamId*/, const FString& /*Reason*/);
+
+// Lockstep tick result for Frame. JsonResult is the script's result arg (an array if it emitted
+// several). bIsStale means the script missed this tick's budget and the previous result is repeated.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FNodeLockstepResultSignature, int64, Frame, const FString&, JsonResult, const TArray<uint8>&, Binary, bool, bIsStale);
+DECLARE_TS_MULTICAST_DELEGATE_FourParams(FNodeLockstepResultNativeSignature, int64 /*Frame*/, const FString& /*JsonResult*/, const TArray<TArray<uint8>>& /*Buffers*/, bool /*bIsStale*/);
+
+UENUM(BlueprintType)
+enum class ENodeEventDispatch : uint8
+{
+	//OnEvent and OnEventNative are broadcast on the game thread (default)
+	GameThread,
+
+	//Only OnEventNative is broadcast, on a background task graph worker. Events with the same
+	//name are handled one at a time in arrival order; different names may run concurrently.
+	BackgroundTask,
+
+	//Only OnEventNative is broadcast, inline on the pipe reader thread. Keep handlers short,
+	//the next frame isn't decoded until they return.
+	ReaderThread,
+};
+
+//Periodic runtime sample of the bridge process (empty Script) or of one subprocess script.
+USTRUCT(BlueprintType)
+struct FNodeRuntimeStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	//Subprocess script name, empty for the bridge process which hosts all inline scripts.
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	FString Script;
+
+	//Event-loop delay over the sample window, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	float EventLoopDelayMeanMs = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	float EventLoopDelayP50Ms = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	float EventLoopDelayP99Ms = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	float EventLoopDelayMaxMs = 0.f;
+
+	//CPU time used since the previous sample, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	float CpuUserMs = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	float CpuSystemMs = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	int64 RssBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	int64 HeapUsedBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Stats")
+	int64 HeapTotalBytes = 0;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FNodeRuntimeStatsSignature, const FNodeRuntimeStats&, Stats);
+
+//Kind is "cpuprofile" or "heapsnapshot". FilePath is empty and ErrorMessage set on failure.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FNodeProfileWrittenSignature, const FString&, ScriptName, const FString&, Kind, const FString&, FilePath, const FString&, ErrorMessage);
+
 USTRUCT(BlueprintType)
 struct FNodeJsProcessParams
 {
@@ -64,6 +152,71 @@ struct FNodeJsProcessParams
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "NodeJs Params")
 	bool bSyncCLIParams = true;
 
+	//Frames larger than this (bytes) are sent as fragments on the low priority bulk lane so
+	//control frames and small events can be written in between. Applies to both directions.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	int32 BulkFrameThreshold = 256 * 1024;
+
+	//Slice size (bytes) used when fragmenting bulk frames.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	int32 FrameFragmentSize = 64 * 1024;
+
+	//Max unacknowledged bytes per stream in flight (each direction). Bounds stream buffering.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	int32 StreamWindowBytes = 4 * 1024 * 1024;
+
+	//Event names (node->UE) sent in delta mode, with their keyframe interval. Only changed paths
+	//and buffer ranges are sent between keyframes; OnEvent still receives the full value.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	TMap<FString, int32> DeltaEvents;
+
+	//Idle node children kept pre-started for subprocess scripts. A launch or watch reload loads the
+	//script into one of them instead of paying node startup. Each idle child costs a node process.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	int32 SubprocessPoolSize = 0;
+
+	//Sample event-loop delay, cpu and memory of the bridge and every subprocess script this
+	//often (ms) and report it on OnRuntimeStats. 0 = off.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	int32 RuntimeStatsIntervalMs = 0;
+
+	//Trace every event hop across the bridge from process start (see StartEventTrace).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	bool bTraceEvents = false;
+
+	//Lockstep: every component tick sends DeltaTime plus the inputs batched since the last tick to
+	//LockstepScript, then blocks the game thread up to LockstepBudgetMicros for its result.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	bool bLockstep = false;
+
+	//Script receiving lockstep ticks. Empty = default script.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	FString LockstepScript;
+
+	//Max time the game thread waits for a tick result each tick.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	int32 LockstepBudgetMicros = 2000;
+
+	//On a missed deadline broadcast the previous result again (flagged stale) instead of nothing.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	bool bLockstepReusePreviousResult = true;
+
+	//Script side: ipc.on(LockstepTickEvent, (dt, inputs, frame) => ipc.emit(LockstepResultEvent, result))
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	FString LockstepTickEvent = TEXT("tick");
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	FString LockstepResultEvent = TEXT("tickResult");
+
+	//Record both directions of the frame stream to a .nuerec file every time the process starts.
+	//See StartStreamRecording for the file location.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	bool bRecordFrameStream = false;
+
+	//Recording file; relative paths are relative to Saved/NodeJs/Recordings. Empty = timestamped name.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, AdvancedDisplay, Category = "NodeJs Params")
+	FString FrameStreamRecordingFile;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "NodeJs Params")
 	bool bScriptLogsOnGamethread = true;
 
@@ -107,6 +260,24 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "NodeJs Events")
 	FNodeEventSignature OnEvent;
 
+	//C++ only. Fires for every script event, on the thread chosen by EventDispatchPolicies.
+	FNodeEventNativeSignature OnEventNative;
+
+	//Lockstep tick results, broadcast on the game thread within the tick that requested them
+	UPROPERTY(BlueprintAssignable, Category = "NodeJs Events")
+	FNodeLockstepResultSignature OnLockstepResult;
+
+	//C++ only. As OnLockstepResult with every result buffer.
+	FNodeLockstepResultNativeSignature OnLockstepResultNative;
+
+	//Lockstep ticks sent so far
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Events")
+	int64 LockstepFrame = 0;
+
+	//Lockstep ticks whose result didn't arrive within LockstepBudgetMicros
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Events")
+	int32 LockstepMissedDeadlines = 0;
+
 	//Any console.log message will be sent here (process.js logs are filtered out)
 	UPROPERTY(BlueprintAssignable, Category = "NodeJs Events")
 	FNodeConsoleLogSignature OnConsoleLog;
@@ -131,10 +302,28 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Npm Events")
 	FNpmInstallResultSignature OnNpmDependenciesResolved;
 
+	//Periodic node-side runtime samples, see NodeJsProcessParams.RuntimeStatsIntervalMs
+	UPROPERTY(BlueprintAssignable, Category = "NodeJs Events")
+	FNodeRuntimeStatsSignature OnRuntimeStats;
+
+	//A .cpuprofile or .heapsnapshot requested via StopCpuProfile/WriteHeapSnapshot was written
+	UPROPERTY(BlueprintAssignable, Category = "NodeJs Events")
+	FNodeProfileWrittenSignature OnProfileWritten;
+
+	//Latest runtime sample per process, keyed by script (empty = bridge process). A subprocess
+	//entry is removed when its script ends; all are cleared when the process stops or restarts.
+	UPROPERTY(BlueprintReadOnly, Category = "NodeJs Events")
+	TMap<FString, FNodeRuntimeStats> LatestRuntimeStats;
+
 	//CustoSmize these for your script
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "NodeJs Parameters")
 	FNodeJsScriptParams DefaultScriptParams;
 
+	//Which thread script events are dispatched on, per event name. Unlisted events use GameThread.
+	//Non game thread policies only broadcast OnEventNative; use them for heavy payload decoding.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "NodeJs Parameters")
+	TMap<FString, ENodeEventDispatch> EventDispatchPolicies;
+
 	//Core process parameters for establishing the process bridge. Generally you don't need to change these params.
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "NodeJs Parameters")
 	FNodeJsProcessParams NodeJsProcessParams;
@@ -157,6 +346,116 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
 	void EmitEventWithBinary(const FString& EventName, const FString& JsonArgs, const TArray<uint8>& Binary, const FString& ScriptName = TEXT(""));
 
+	//Send one event to many scripts with a single frame. Scripts entries are script names, or patterns
+	//with * and ? wildcards; an empty list (or "*") targets every running script. Inline scripts share
+	//one decoded copy of the args and buffers by reference: a script that mutates them changes what
+	//the scripts after it receive, so handlers should treat them as read-only.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void MulticastEvent(const FString& EventName, const FString& JsonArgs, const TArray<FString>& Scripts);
+
+	//As MulticastEvent with a binary buffer, see EmitEventWithBinary.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void MulticastEventWithBinary(const FString& EventName, const FString& JsonArgs, const TArray<uint8>& Binary, const TArray<FString>& Scripts);
+
+	//Open a binary stream to a script. The script receives it as ipc.on(StreamName, (readable, info) => ...)
+	//with a node Readable. Only inline scripts can receive streams. Returns the stream id.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	int32 OpenStream(const FString& StreamName, int64 ExpectedSize = -1, const FString& ScriptName = TEXT(""));
+
+	//Queue a chunk on an open stream. Returns false (and sends nothing) if the chunk would exceed
+	//StreamWindowBytes of unacknowledged data; retry after OnStreamWritableNative.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	bool WriteStream(int32 StreamId, const TArray<uint8>& Chunk);
+
+	//Bytes WriteStream will currently accept for StreamId (0 if unknown or full).
+	UFUNCTION(BlueprintPure, Category = "NodeJs Functions")
+	int64 GetStreamWritableBytes(int32 StreamId);
+
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void EndStream(int32 StreamId);
+
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void AbortStream(int32 StreamId, const FString& Reason);
+
+	//Streams opened by scripts via ipc.createStream(name), and credit for our own streams.
+	//When the process stops or restarts, every open stream is ended as aborted (OnStreamEndNative)
+	//or closed (OnStreamClosedNative) on the thread that stopped it.
+	FNodeStreamOpenNativeSignature OnStreamOpenNative;
+	FNodeStreamChunkNativeSignature OnStreamChunkNative;
+	FNodeStreamEndNativeSignature OnStreamEndNative;
+	FNodeStreamWritableNativeSignature OnStreamWritableNative;
+	FNodeStreamClosedNativeSignature OnStreamClosedNative;
+
+	//Turn lockstep ticking on or off at runtime.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void SetLockstepEnabled(bool bEnabled);
+
+	//Batch an input for the next lockstep tick. Inputs reach the script as an array in call order.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void AddLockstepInput(const FString& JsonInput);
+
+	//As AddLockstepInput, followed by Binary as a Buffer input.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void AddLockstepInputWithBinary(const FString& JsonInput, const TArray<uint8>& Binary);
+
+	//Put a node->UE event in delta mode with a full keyframe every KeyframeInterval updates. 0 = off.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void SetEventDelta(const FString& EventName, int32 KeyframeInterval = 30);
+
+	//Ask the sender of a delta event for a full keyframe on its next update. Empty ScriptName = default script.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void RequestKeyframe(const FString& EventName, const FString& ScriptName = TEXT(""));
+
+	//Resize the warm subprocess pool at runtime. 0 = fork on demand.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void SetSubprocessPoolSize(int32 PoolSize);
+
+	//Start a CPU profile via node's inspector. ScriptName targets a subprocess script; leave it
+	//empty (or name an inline script) to profile the bridge process hosting inline scripts.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void StartCpuProfile(const FString& ScriptName = TEXT(""));
+
+	//Stop the profile and write a .cpuprofile to Saved/NodeJs/Profiles; reported on OnProfileWritten.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void StopCpuProfile(const FString& ScriptName = TEXT(""));
+
+	//Write a .heapsnapshot to Saved/NodeJs/Profiles; reported on OnProfileWritten.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void WriteHeapSnapshot(const FString& ScriptName = TEXT(""));
+
+	//Change the runtime stats sampling period at runtime. 0 = off.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void SetRuntimeStatsInterval(int32 IntervalMs);
+
+	//Start timestamping every event at each hop (Unreal send, node parse, script delivery,
+	//node write, Unreal decode, dispatch). Adds a few JSON fields per event while on.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void StartEventTrace();
+
+	//Stop tracing and write the collected hops as Chrome trace JSON (chrome://tracing, Perfetto).
+	//Relative paths go to Saved/Profiling/NodeJs. Returns the file written, empty on failure.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	FString StopEventTrace(const FString& Filename = TEXT(""));
+
+	//Change where EventName is dispatched at runtime. Safe to call while events are arriving.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void SetEventDispatchPolicy(const FString& EventName, ENodeEventDispatch Policy);
+
+	//Start writing both directions of the frame stream to Filename (see FrameStreamRecordingFile).
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	bool StartStreamRecording(const FString& Filename = TEXT(""));
+
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void StopStreamRecording();
+
+	//Feed the node->UE side of a recording through the frame decoder and normal event dispatch,
+	//without a live process. Runs on a background thread; timing is logged to LogNodeJs.
+	//Refused while the process is running or another replay is in progress; the process can't
+	//be started until the replay ends. Anything sent to node meanwhile, including replies the
+	//replayed frames trigger, is discarded.
+	UFUNCTION(BlueprintCallable, Category = "NodeJs Functions")
+	void ReplayStreamRecording(const FString& Filename, bool bRealtime = false);
+
 	//C++ convenience overload taking a structured json object as the single arg.
 	void EmitEvent(const FString& EventName, const TSharedRef<class FJsonObject>& JsonArg, const FString& ScriptName = TEXT(""));
 
@@ -173,15 +472,117 @@ protected:
 	//Decodes the framed byte stream coming back from process.js (runs on bg thread).
 	FNodeFrameCodec Decoder;
 
+	//Reader-thread copy of EventDispatchPolicies.
+	TMap<FString, ENodeEventDispatch> ActiveDispatchPolicies;
+	FCriticalSection DispatchPolicyLock;
+
+	ENodeEventDispatch GetEventDispatchPolicy(const FString& EventName);
+
+	//BackgroundTask dispatch: a serial queue per event name, drained by at most one task at a time
+	struct FBackgroundDispatch
+	{
+		FString ArgsJson;
+		TArray<TArray<uint8>> Buffers;
+		uint64 TraceId = 0;
+	};
+	struct FBackgroundDispatchQueue
+	{
+		TArray<FBackgroundDispatch> Pending;
+	};
+	TMap<FString, FBackgroundDispatchQueue> BackgroundDispatchQueues;
+	FCriticalSection BackgroundDispatchLock;
+
+	void QueueBackgroundDispatch(const FString& EventName, FBackgroundDispatch&& Dispatch);
+	void DrainBackgroundDispatch(const FString& EventName);
+
 	//Routes a single decoded frame to the relevant delegates.
 	void HandleFrame(uint8 Type, const FString& Header, const TArray<uint8>& Binary);
 
 	//Frame helpers towards process.js.
 	void SendControl(const FString& CommandLine);
-	void SendEventFrame(const FString& EventName, const FString& JsonArgs, const TArray<TArray<uint8>>& Buffers, const FString& ScriptName);
+	//MulticastScripts, if set, replaces ScriptName with a target list/pattern (see MulticastEvent).
+	void SendEventFrame(const FString& EventName, const FString& JsonArgs, const TArray<TArray<uint8>>& Buffers, const FString& ScriptName, const TArray<FString>* MulticastScripts = nullptr);
+
+	//Lockstep state shared between the game thread (tick) and the reader thread (result).
+	FCriticalSection LockstepLock;
+	FEvent* LockstepSignal = nullptr;
+	TArray<TSharedPtr<class FJsonValue>> PendingLockstepInputs;
+	TArray<TArray<uint8>> PendingLockstepBuffers;
+	int64 AwaitedLockstepFrame = 0;
+	int64 LockstepResultFrame = 0;
+	FString LockstepResultJson;
+	TArray<TArray<uint8>> LockstepResultBuffers;
+
+	void RunLockstepTick(float DeltaTime);
+	void HandleTickResult(const FString& Header, const TArray<uint8>& Binary);
+
+	//Rebuilds delta-mode events; reader thread only.
+	FNodeDeltaDecoder DeltaDecoder;
+
+	FNodeStreamRecorder StreamRecorder;
+
+	//Replay thread stands in for the reader thread, so the two never run at the same time.
+	TFuture<void> ReplayTask;
+	std::atomic<bool> bReplaying{ false };
+	std::atomic<bool> bCancelReplay{ false };
+	FNodeEventTracer EventTracer;
+
+	//Stamp an Unreal-side hop if TraceId is set (0 = event isn't traced).
+	void TraceDispatch(uint64 TraceId, const TCHAR* Stage);
+
+	//UE->node streams, touched by the caller's thread (writes) and the reader thread (acks).
+	struct FOutboundStream
+	{
+		int64 Sent = 0;
+		int64 InFlight = 0;
+	};
+	TMap<int32, FOutboundStream> OutboundStreams;
+	FCriticalSection StreamLock;
+	int32 NextStreamId = 1;
+
+	//node->UE streams; reader thread only.
+	struct FInboundStream
+	{
+		FString Name;
+		int64 Received = 0;
+	};
+	TMap<int32, FInboundStream> InboundStreams;
+
+	void HandleStreamFrame(const FString& Header, const TArray<uint8>& Binary);
+
+	//End every stream in both directions as aborted; the process they belonged to is gone.
+	void AbortOpenStreams(const FString& Reason);
+
+	//LatestRuntimeStats is game thread only; empties it there.
+	void ClearRuntimeStats();
+	void SendStreamFrame(const TSharedRef<class FJsonObject>& HeaderObj, const TArray<uint8>& Chunk);
+
+	//Outbound priority lanes; every frame to process.js goes through here.
+	FNodeFrameLanes OutboundLanes;
+	std::atomic<bool> bOutboundPumpActive{ false };
+
+	//Set on teardown
+	std::atomic<bool> bOutboundClosed{ false };
+
+	//Background tasks in flight that capture this (bulk pump, BackgroundTask dispatch).
+	//BackgroundTasksIdle is triggered when the count drops to zero; teardown waits on it.
+	std::atomic<int32> BackgroundTasks{ 0 };
+	FEvent* BackgroundTasksIdle = nullptr;
+	FCriticalSection BackgroundTasksLock;
+
+	void BeginBackgroundTask();
+	void EndBackgroundTask();
+
+	//TraceId (optional) gets "queued" / "write" hops as the frame enters the lanes and hits the pipe
+	void QueueFrame(TArray<uint8>&& Frame, ENodeFrameLane::Type Lane, uint64 TraceId = 0);
+
+	//Writes queued frames to the pipe. Control/event lanes are drained on the calling thread;
+	//bulk fragments are handed to a background task so the caller never blocks on them.
+	void PumpOutbound(bool bOnBackgroundThread);
 
 	//UCLIProcessComponent overrides
 	virtual void StartProcess() override;
+	virtual void StopProcess() override;
 
 	//UActorComponent overrides
 	virtual void InitializeComponent() override;
@@ -0,0 +1,58 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+//
+// Receiver side of delta-encoded state events. For event names put in delta
+// mode, process.js sends a full keyframe every N updates and only the changed
+// paths / buffer ranges in between (see the delta section of process.js for
+// the wire format). This rebuilds the full args and buffers of every update so
+// delegates see the same payload as without delta mode.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+class FJsonValue;
+
+/**
+ * Holds the last full value per delta stream (script + event name). Not
+ * thread-safe: feed it from the frame reader only.
+ */
+class NODEJS_API FNodeDeltaDecoder
+{
+public:
+	enum class EResult : uint8
+	{
+		Applied,      // InOutArgs / InOutBuffers hold the full value
+		Dropped,      // can't be rebuilt, a keyframe is already on its way
+		NeedKeyframe, // can't be rebuilt (missed, out of order or mismatched update): request a keyframe
+	};
+
+	/**
+	 * Apply the "delta" object of an event frame. InOutArgs holds the frame's args
+	 * (keyframes) and InOutBuffers its binary table; both hold the full value when
+	 * Applied. Updates that can't be rebuilt should not be delivered.
+	 */
+	EResult Apply(const FString& StreamKey, const FJsonObject& Delta, TArray<TSharedPtr<FJsonValue>>& InOutArgs, TArray<TArray<uint8>>& InOutBuffers);
+
+	void Reset();
+
+private:
+	struct FDeltaState
+	{
+		int64 Seq = 0;
+		bool bKeyframeRequested = false;
+		TSharedPtr<FJsonValue> Args;
+		TArray<TArray<uint8>> Buffers;
+	};
+
+	TMap<FString, FDeltaState> States;
+
+	// Drop the held value of a stream that can't be rebuilt anymore and request a
+	// keyframe, unless one is already on its way.
+	static EResult Resync(FDeltaState& State);
+
+	// Set (or remove, if Value is null) the element at Path below Node. Objects are
+	// edited in place; arrays are copied along the path and Node is updated. Returns
+	// false if the path doesn't exist up to its last key (missing key, bad index, scalar).
+	static bool SetPath(TSharedPtr<FJsonValue>& Node, const TArray<TSharedPtr<FJsonValue>>& Path, int32 Depth, const TSharedPtr<FJsonValue>& Value);
+};
@@ -0,0 +1,73 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+//
+// Cross-boundary event tracing. When enabled, EVENT frame headers carry a
+// "trace" object {id, parent?, hops:[[stage, micros], ...]} and each side stamps
+// the stages it owns:
+//   Unreal : SendEventFrame -> queued -> write    ... decode -> dispatch -> handled
+//   node   : handleFrame -> deliver -> handled    ... emit -> write
+//            (subprocess targets: deliver -> receive -> handled, stamped in the child)
+// "queued" / "write" are stamped when the frame enters the lanes and when its
+// last byte is handed to the pipe. node reports the hops of events it received,
+// and the write hop of events it emitted, in TRACE frames; events it emits carry
+// their own hops (and the id of the event being handled as parent). A multicast
+// event keeps handleFrame/fanout under its id, and each target's hops go under a
+// node id of their own with the multicast as parent.
+// Timestamps are wall-clock microseconds since the Unix epoch on both sides, so
+// hops across the boundary are only as aligned as the two processes' clocks.
+//
+// The collected hops are written as a Chrome trace (chrome://tracing, Perfetto)
+// with one async track per event and one nested slice per hop. Unreal Insights
+// gets a bookmark per Unreal-side hop as it happens ("NodeJs <id> <stage>") and
+// one per batch of node hops as it arrives, listing them with offsets.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+class NODEJS_API FNodeEventTracer
+{
+public:
+	/** Wall-clock microseconds since the Unix epoch, with FPlatformTime resolution. */
+	static int64 NowMicros();
+
+	void Start();
+	void Stop();
+	bool IsEnabled() const { return bEnabled; }
+
+	uint64 NewTraceId();
+
+	/** Record one hop. Name/Script are only stored the first time an id is seen. */
+	void AddHop(uint64 TraceId, const TCHAR* Stage, int64 Micros, bool bNodeSide, const FString& EventName = FString(), const FString& ScriptName = FString(), uint64 ParentId = 0);
+
+	/** Record every [stage, micros] pair of a JSON hops array stamped by node. */
+	void AddNodeHops(uint64 TraceId, const TArray<TSharedPtr<class FJsonValue>>& Hops, const FString& EventName = FString(), const FString& ScriptName = FString(), uint64 ParentId = 0);
+
+	/** Write everything collected so far as Chrome trace JSON. */
+	bool WriteChromeTrace(const FString& Filename) const;
+
+	void Reset();
+
+private:
+	struct FHop
+	{
+		FString Stage;
+		int64 Micros = 0;
+		bool bNodeSide = false;
+	};
+
+	struct FTrace
+	{
+		FString EventName;
+		FString ScriptName;
+		uint64 ParentId = 0;
+		TArray<FHop> Hops;
+	};
+
+	FTrace* FindOrAddLocked(uint64 TraceId, const FString& EventName, const FString& ScriptName, uint64 ParentId);
+
+	mutable FCriticalSection Lock;
+	TMap<uint64, FTrace> Traces;
+	std::atomic<bool> bEnabled{ false };
+	std::atomic<uint64> NextTraceId{ 1 };
+};
@@ -16,6 +16,24 @@
 // EVENT frames carry, in their BINARY field, a "binary table" of N buffers so a
 // single event can interweave multiple binary blobs alongside its JSON args.
 // Table format: [4] count, then count * ( [4] len, [len] bytes ).
+//
+// FRAGMENT frames let a large frame be split so smaller, higher priority frames
+// can be written between its pieces (see FNodeFrameLanes). The HEADER is empty
+// and the BINARY field is:
+//   [4] FRAGMENT_ID (uint32, unique per in-flight frame and direction)
+//   [1] FLAGS       (bit0 = last fragment)
+//   [..] a slice of the complete encoded inner frame (magic included)
+// Fragments of one frame arrive in order; fragments of different frames may
+// interleave with each other and with whole frames. A receiver keeps at most
+// MaxPartialFrames frames / MaxPartialBytes bytes in reassembly and evicts the
+// least recently extended one past that.
+//
+// STREAM frames carry a JSON header {op, id, ...} and, for 'data', a chunk of an
+// unbounded binary transfer in BINARY. Ops: open {id,script,name,size},
+// data {id}, end {id,total}, abort {id,reason}, and from the receiver ack
+// {id,bytes} (bounds the unacked bytes the sender keeps in flight) or reject
+// {id,reason} when a stream can't be delivered.
+// Sizes and totals are 64-bit; only individual chunks are limited to uint32.
 
 #pragma once
 
@@ -27,11 +45,18 @@ namespace ENodeFrameType
 	{
 		Log        = 0x01, // node->UE  : script console.log text
 		Action     = 0x02, // node->UE  : "begin|end|reload <scriptPath>"
-		Event      = 0x03, // both ways : JSON {script,name,args} + binary table
+		Event      = 0x03, // both ways : JSON {script,name,args} + binary table; UE->node may use {scripts:[...]} to multicast
 		Error      = 0x04, // node->UE  : JSON {script,message,stack}
 		Control    = 0x05, // UE->node  : command line text
 		ProcessLog = 0x06, // node->UE  : process-level (wrapper) log text
 		Npm        = 0x07, // node->UE  : JSON {installed:bool, error:string}
+		Fragment   = 0x08, // both ways : [4]id [1]flags + slice of an encoded frame
+		Stream     = 0x09, // both ways : JSON {op,id,...} + chunk
+		Trace      = 0x0A, // node->UE  : JSON {id, hops:[[stage,micros],...]}
+		Profile    = 0x0B, // node->UE  : JSON {script, kind, path, error}
+		Stats      = 0x0C, // node->UE  : JSON {script, eventLoopDelay, cpu, memory}
+		Tick       = 0x0D, // UE->node  : JSON {script,frame,dt,name,reply,inputs} + binary table
+		TickResult = 0x0E, // node->UE  : JSON {script,frame,args} + binary table
 	};
 }
 
@@ -49,20 +74,49 @@ public:
 	static TArray<uint8> Encode(uint8 Type, const FString& Header, const TArray<uint8>& Binary);
 	static TArray<uint8> Encode(uint8 Type, const FString& Header);
 
+	/** Wrap a slice of an encoded frame into a FRAGMENT frame. */
+	static TArray<uint8> EncodeFragment(uint32 FragmentId, bool bLast, const uint8* Slice, int32 SliceLen);
+
 	/** Build/parse the binary table used inside EVENT frames. */
 	static TArray<uint8> BuildBinaryTable(const TArray<TArray<uint8>>& Buffers);
 	static bool ParseBinaryTable(const TArray<uint8>& Table, TArray<TArray<uint8>>& OutBuffers);
 
 	/** Feed raw bytes from the pipe; complete frames are emitted via OnFrame. */
 	void Feed(const TArray<uint8>& Chunk);
+	void Feed(const uint8* Data, int32 Num);
+
+	/** Drop buffered bytes and partial fragments, e.g. when the sending process restarts. */
+	void Reset();
 
 	/** Called once per fully-decoded frame (on the calling thread of Feed). */
 	TFunction<void(uint8 Type, const FString& Header, const TArray<uint8>& Binary)> OnFrame;
 
+	static constexpr int32 MaxPartialFrames = 16;
+	static constexpr int64 MaxPartialBytes = 1024 * 1024 * 1024;
+
 private:
 	TArray<uint8> Accum;
 
+	//Partially received fragmented frames keyed by fragment id.
+	struct FPartialFrame
+	{
+		TArray<uint8> Bytes;
+		uint64 LastTouched = 0;
+	};
+	TMap<uint32, FPartialFrame> Partials;
+	int64 PartialBytes = 0;
+	uint64 FragmentsSeen = 0;
+
+	void EvictStalestPartial(uint32 KeepId);
+
 	void TryParse();
+	void HandleFragment(const TArray<uint8>& Binary);
 	bool MatchMagicAt(int32 Index) const;
 	int32 FindMagicFrom(int32 Start) const;
+
+	/**
+	 * Decode one complete frame starting at Start. Returns false if Buffer doesn't
+	 * yet hold the whole frame; OutEnd is the index just past the frame on success.
+	 */
+	static bool DecodeAt(const TArray<uint8>& Buffer, int32 Start, int32& OutEnd, uint8& OutType, FString& OutHeader, TArray<uint8>& OutBinary);
 };
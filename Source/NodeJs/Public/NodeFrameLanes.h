@@ -0,0 +1,70 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+//
+// Outbound priority lanes for the NUE frame stream. Frames are queued into a
+// lane by priority class and popped one write-unit at a time, highest lane
+// first, so a control frame or small event never waits for more than a single
+// fragment of an in-flight bulk transfer. Frames larger than BulkThreshold go
+// into the Bulk lane and are cut into FRAGMENT frames lazily as they're popped.
+// Order is preserved within a lane, not across lanes, so traffic that must stay
+// ordered regardless of size (stream chunks) is queued on the Bulk lane directly.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace ENodeFrameLane
+{
+	enum Type : uint8
+	{
+		Control = 0, // control commands, lifecycle and error frames
+		Event   = 1, // logs and events below the bulk threshold
+		Bulk    = 2, // anything larger, written as fragments; ordered stream traffic
+		Count   = 3,
+	};
+}
+
+/**
+ * Thread-safe lane queue. Any thread may Enqueue; a single writer at a time
+ * should PopNext and write the result to the pipe.
+ */
+class NODEJS_API FNodeFrameLanes
+{
+public:
+	/**
+	 * Frames above BulkThreshold are routed to the Bulk lane and fragmented into
+	 * FragmentSize payload bytes each. Safe to call while another thread pumps.
+	 */
+	void SetSizes(int32 InBulkThreshold, int32 InFragmentSize);
+
+	/**
+	 * Queue an encoded frame. Lane is the requested class; large frames are demoted to Bulk.
+	 * TraceId (optional) is handed back by PopNext with the unit that completes the frame.
+	 */
+	void Enqueue(TArray<uint8>&& Frame, ENodeFrameLane::Type Lane, uint64 TraceId = 0);
+
+	/**
+	 * Pop the next unit to write (a whole frame or one fragment) from the highest
+	 * priority non-empty lane. If bIncludeBulk is false the Bulk lane is skipped.
+	 * OutTraceId is set to the frame's trace id if this unit is its last, else 0.
+	 */
+	bool PopNext(TArray<uint8>& OutBytes, bool bIncludeBulk = true, uint64* OutTraceId = nullptr);
+
+	bool HasPending() const;
+
+	void Reset();
+
+private:
+	struct FPendingFrame
+	{
+		TArray<uint8> Bytes;
+		int32 Offset = 0;
+		uint32 FragmentId = 0;
+		uint64 TraceId = 0;
+	};
+
+	mutable FCriticalSection Lock;
+	int32 BulkThreshold = 256 * 1024;
+	int32 FragmentSize = 64 * 1024;
+	TArray<FPendingFrame> Lanes[ENodeFrameLane::Count];
+	uint32 NextFragmentId = 1;
+};
@@ -0,0 +1,86 @@
+// Copyright getnamo. NodeJs-Unreal v2.0.0
+//
+// Capture and replay of the raw NUE byte stream, both directions, for offline
+// decode/dispatch benchmarks and for replaying captured sessions against newer
+// plugin versions without the engine or the original script inputs.
+//
+// File format (.nuerec, all integers little-endian):
+//   [4] MAGIC   = 'N','U','E','R'
+//   [1] VERSION = 1
+//   [3] reserved
+//   then any number of records:
+//     [8] TIMESTAMP (uint64 microseconds since recording start)
+//     [1] DIRECTION (ENodeStreamDirection)
+//     [4] LENGTH    (uint32)
+//     [LENGTH] bytes exactly as written to / read from the pipe
+//
+// Content/Scripts/test/replay.js reads the same format on the node side.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace ENodeStreamDirection
+{
+	enum Type : uint8
+	{
+		ToNode   = 0, // UE->node  : bytes handed to the process stdin
+		FromNode = 1, // node->UE  : bytes read from the process stdout
+	};
+}
+
+/**
+ * Thread-safe appender; any thread may Record while the file is open. Records
+ * are buffered under a short lock; the disk write happens outside it, in order.
+ */
+class NODEJS_API FNodeStreamRecorder
+{
+public:
+	~FNodeStreamRecorder();
+
+	bool Open(const FString& Filename);
+	void Close();
+	bool IsRecording() const { return bIsRecording; }
+
+	void Record(ENodeStreamDirection::Type Direction, const uint8* Data, int32 Num);
+
+private:
+	// Caller holds WriteLock
+	void WriteBlock(const TArray<uint8>& Block);
+
+	// Guards Pending, StartSeconds and the recording state
+	FCriticalSection Lock;
+	// Guards File; taken before Lock is released so blocks reach the disk in order
+	FCriticalSection WriteLock;
+	TUniquePtr<IFileHandle> File;
+	TArray<uint8> Pending;
+	double StartSeconds = 0.0;
+	std::atomic<bool> bIsRecording{ false };
+};
+
+/** Reads a .nuerec through a memory mapping and plays records back to a sink. */
+class NODEJS_API FNodeStreamReplayer
+{
+public:
+	~FNodeStreamReplayer();
+
+	bool Open(const FString& Filename);
+	void Close();
+
+	/**
+	 * Feed every record in Direction to Sink, in file order. With bRealtime the
+	 * original inter-record gaps are reproduced, otherwise it runs flat out.
+	 * Returns the number of records played. Blocks the calling thread until done
+	 * or until *bCancel is set.
+	 */
+	int32 Replay(ENodeStreamDirection::Type Direction, bool bRealtime, TFunctionRef<void(const uint8* Data, int32 Num)> Sink, const std::atomic<bool>* bCancel = nullptr) const;
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+};